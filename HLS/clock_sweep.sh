@@ -0,0 +1,47 @@
+#!/bin/bash
+# Synthesize mlkem512_keygen_top at several clock targets and tabulate the
+# top-level latency (cycles and ns), slack and resources from each compile
+# report into reports/clock_sweep.md.
+#
+# Usage: ./clock_sweep.sh [MHz ...]      (default: 50 100 150 200)
+# Requires v++ (Vitis 2024.1) on PATH.
+
+set -e
+cd "$(dirname "$0")"
+
+CLOCKS=${*:-50 100 150 200}
+OUT=../reports/clock_sweep.md
+
+mkdir -p ../reports
+{
+    echo "| Clock (MHz) | Slack (ns) | Latency (cycles) | Latency (ns) | BRAM | DSP | FF | LUT |"
+    echo "|-------------|------------|------------------|--------------|------|-----|----|-----|"
+} > "$OUT"
+
+for f in $CLOCKS; do
+    cfg=hls_config_${f}MHz.cfg
+    work=sweep_${f}MHz
+
+    # hls_config.cfg has no trailing newline: terminate it before appending
+    { sed "s/^clock=.*/clock=${f}MHz/" hls_config.cfg; echo; } > "$cfg"
+    # Split each Keccak round over two cycles at 200 MHz and above
+    if [ "$f" -ge 200 ]; then
+        echo "syn.cflags=-DKECCAK_ROUND_II=2" >> "$cfg"
+    fi
+
+    v++ -c --mode hls --config "$cfg" --work_dir "$work"
+
+    rpt=$(find "$work" -name hls_compile.rpt -o -name csynth.rpt | head -1)
+    if [ -z "$rpt" ]; then
+        echo "| $f | no report | | | | | | |" >> "$OUT"
+        continue
+    fi
+
+    # Top-level row: | + top | Issue | Slack | Lat cyc | Lat ns | Iter | II | Trip | Pipe | BRAM | DSP | FF | LUT | URAM |
+    grep -m1 "+ mlkem512_keygen_top " "$rpt" | awk -F'|' -v f="$f" '
+        function trim(s) { gsub(/^ +| +$/, "", s); return s }
+        { printf "| %s | %s | %s | %s | %s | %s | %s | %s |\n",
+                 f, trim($4), trim($5), trim($6), trim($11), trim($12), trim($13), trim($14) }' >> "$OUT"
+done
+
+cat "$OUT"
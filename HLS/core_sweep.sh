@@ -0,0 +1,62 @@
+#!/bin/bash
+# Run C simulation and synthesis of mlkem512_keygen_multi_top for several
+# core counts and tabulate resource scaling and estimated throughput into
+# reports/core_sweep.md.
+#
+# Throughput estimate: each core completes one keypair every L_core cycles
+# (latency of its mlkem512_keygen instance) and the collector drains one
+# keypair every KEYGEN_KEY_BEATS (304) cycles, so
+#     keys/s = f_clk * min(N / L_core, 1 / 304)
+#
+# Usage: ./core_sweep.sh [N ...]         (default: 1 2 4)
+# Requires vitis-run and v++ (Vitis 2024.1) on PATH; clock is taken from hls_config.cfg.
+
+set -e
+cd "$(dirname "$0")"
+
+CORES=${*:-1 2 4}
+OUT=../reports/core_sweep.md
+MHZ=$(sed -n 's/^clock=\([0-9.]*\)MHz/\1/Ip' hls_config.cfg)
+
+mkdir -p ../reports
+{
+    echo "| Cores | BRAM | DSP | FF | LUT | Core latency (cycles) | Est. keys/s @ ${MHZ} MHz |"
+    echo "|-------|------|-----|----|-----|-----------------------|--------------------------|"
+} > "$OUT"
+
+for n in $CORES; do
+    cfg=hls_config_${n}core.cfg
+    work=sweep_${n}core
+
+    # hls_config.cfg has no trailing newline: terminate it before appending
+    { sed -e "s/^syn.top=.*/syn.top=mlkem512_keygen_multi_top/" hls_config.cfg; echo; } > "$cfg"
+    echo "syn.cflags=-DKEYGEN_CORES=${n}" >> "$cfg"
+    echo "tb.cflags=-DKEYGEN_CORES=${n}" >> "$cfg"
+
+    vitis-run --mode hls --csim --config "$cfg" --work_dir "$work"
+    v++ -c --mode hls --config "$cfg" --work_dir "$work"
+
+    rpt=$(find "$work" -name hls_compile.rpt -o -name csynth.rpt | head -1)
+    if [ -z "$rpt" ]; then
+        echo "| $n | no report | | | | | |" >> "$OUT"
+        continue
+    fi
+
+    # | + name | Issue | Slack | Lat cyc | Lat ns | Iter | II | Trip | Pipe | BRAM | DSP | FF | LUT | URAM |
+    top=$(grep -m1 "+ mlkem512_keygen_multi_top " "$rpt")
+    core=$(grep -m1 "+ mlkem512_keygen " "$rpt" | awk -F'|' '{ gsub(/ /, "", $5); print $5 }')
+    echo "$top" | awk -F'|' -v n="$n" -v lat="$core" -v mhz="$MHZ" '
+        function trim(s) { gsub(/^ +| +$/, "", s); return s }
+        {
+            rate = "-"
+            if (lat ~ /^[0-9]+$/ && lat > 0) {
+                per = n / lat
+                if (per > 1 / 304) per = 1 / 304
+                rate = sprintf("%.0f", per * mhz * 1e6)
+            }
+            printf "| %s | %s | %s | %s | %s | %s | %s |\n",
+                   n, trim($11), trim($12), trim($13), trim($14), lat, rate
+        }' >> "$OUT"
+done
+
+cat "$OUT"
@@ -0,0 +1,65 @@
+#!/bin/bash
+# Known-latency check for mlkem512_keygen_top built with MLKEM_FIXED_LATENCY=1.
+#
+#   1. C simulation over CSIM_SEEDS random seeds: test_fixed_latency in
+#      main_test requires identical per-stage trip counts (G, matrix, PRF,
+#      CBD, NTT, basemul, pack+H) for every seed.
+#   2. Synthesis and C/RTL co-simulation over COSIM_SEEDS seeds: every call
+#      of the top is one cosim transaction, so the min and max latency in the
+#      cosim report must be equal.
+#
+# Results go to reports/ct_check.md; exits non-zero if either check fails.
+#
+# Usage: ./ct_check.sh [CSIM_SEEDS [COSIM_SEEDS]]   (default: 1000 20)
+# Requires vitis-run and v++ (Vitis 2024.1) on PATH.
+
+set -e -o pipefail
+cd "$(dirname "$0")"
+
+CSIM_SEEDS=${1:-1000}
+COSIM_SEEDS=${2:-20}
+OUT=../reports/ct_check.md
+
+# hls_config.cfg has no trailing newline: terminate it before appending
+make_cfg() {
+    { cat hls_config.cfg; echo; } > "$1"
+    echo "syn.cflags=-DMLKEM_FIXED_LATENCY=1" >> "$1"
+    echo "tb.cflags=-DMLKEM_FIXED_LATENCY=1 -DCT_SEEDS=$2" >> "$1"
+}
+
+make_cfg hls_config_ct_csim.cfg "$CSIM_SEEDS"
+make_cfg hls_config_ct.cfg "$COSIM_SEEDS"
+
+csim=PASS
+vitis-run --mode hls --csim --config hls_config_ct_csim.cfg --work_dir ct_csim | tee ct_csim.log || csim=FAIL
+sed -n '/Testing fixed latency/,/PASS\|FAIL/p' ct_csim.log | grep -q '^PASS' || csim=FAIL
+
+v++ -c --mode hls --config hls_config_ct.cfg --work_dir ct_cosim
+vitis-run --mode hls --cosim --config hls_config_ct.cfg --work_dir ct_cosim
+
+# | RTL | Status | Latency min | avg | max | Interval min | avg | max | Total cycles |
+rpt=$(find ct_cosim -name "*cosim.rpt" 2>/dev/null | head -1) || true
+lmin= lavg= lmax=
+if [ -n "$rpt" ]; then
+    read -r lmin lavg lmax < <(grep -m1 "Verilog" "$rpt" | awk -F'|' '
+        function trim(s) { gsub(/^ +| +$/, "", s); return s }
+        { print trim($4), trim($5), trim($6) }') || true
+fi
+[ -n "$lmin" ] || echo "ct_check: no Verilog latency row in ${rpt:-ct_cosim (no cosim report found)}" >&2
+cosim=PASS
+[ -n "$lmin" ] && [ "$lmin" = "$lmax" ] || cosim=FAIL
+
+mkdir -p ../reports
+{
+    echo "| Check | Seeds | Result | Latency min | avg | max |"
+    echo "|-------|-------|--------|-------------|-----|-----|"
+    echo "| csim stage trip counts | $CSIM_SEEDS | $csim | | | |"
+    echo "| cosim top latency (cycles) | $COSIM_SEEDS | $cosim | $lmin | $lavg | $lmax |"
+    echo
+    echo '```'
+    sed -n '/Testing fixed latency/,/PASS\|FAIL/p' ct_csim.log
+    echo '```'
+} > "$OUT"
+
+cat "$OUT"
+[ "$csim" = PASS ] && [ "$cosim" = PASS ]
@@ -2,165 +2,219 @@
 #include "unified.h"
 #include <stdio.h>
 
-const lane_t RC[24] = {
-    0x0000000000000001ULL,0x0000000000008082ULL,0x800000000000808AULL,0x8000000080008000ULL,
-    0x000000000000808BULL,0x0000000080000001ULL,0x8000000080008081ULL,0x8000000000008009ULL,
-    0x000000000000008AULL,0x0000000000000088ULL,0x0000000080008009ULL,0x000000008000000AULL,
-    0x000000008000808BULL,0x800000000000008BULL,0x8000000000008089ULL,0x8000000000008003ULL,
-    0x8000000000008002ULL,0x8000000000000080ULL,0x000000000000800AULL,0x800000008000000AULL,
-    0x8000000080008081ULL,0x8000000000008080ULL,0x0000000080000001ULL,0x8000000080008008ULL
-};
-
-    // Rotation offsets for rho step
-    const int rho_offsets[25] = {
-        0, 1, 62, 28, 27, 36, 44, 6, 55, 20, 3, 10, 43, 25, 39, 41, 45, 15, 21, 8, 18, 2, 61, 56, 14
-    };
+// Keccak-f[1600] tables, generated at compile time (FIPS 202, 3.2)
+
+// rc(t): output bit of the degree-8 LFSR x^8 + x^6 + x^5 + x^4 + 1
+constexpr int keccak_rc_bit(int t) {
+    int r = 1;
+    for (int i = 0; i < t % 255; i++) {
+        r <<= 1;
+        if (r & 0x100)
+            r ^= 0x171;
+    }
+    return r & 1;
+}
 
-void keccak_f1600(lane_t state[25]) {
-#pragma HLS INLINE off
-#pragma HLS ARRAY_PARTITION variable=state complete
-    
+// Round constants: bit 2^j - 1 of RC[ir] is rc(j + 7 * ir)
+constexpr const_table_t<uint64_t, 24> make_keccak_rc() {
+    const_table_t<uint64_t, 24> r{};
+    for (int ir = 0; ir < 24; ir++)
+        for (int j = 0; j < 7; j++)
+            r.v[ir] |= (uint64_t)keccak_rc_bit(j + 7 * ir) << ((1 << j) - 1);
+    return r;
+}
+
+// Rho rotation of lane x + 5y: (t + 1)(t + 2) / 2 along the (x, y) -> (y, 2x + 3y) walk
+constexpr const_table_t<int, 25> make_rho_offsets() {
+    const_table_t<int, 25> r{};
+    int x = 1, y = 0;
+    for (int t = 0; t < 24; t++) {
+        r.v[x + 5 * y] = (t + 1) * (t + 2) / 2 % 64;
+        int nx = y;
+        y = (2 * x + 3 * y) % 5;
+        x = nx;
+    }
+    return r;
+}
+
+// Pi destination of lane x + 5y: y + 5 * ((2x + 3y) mod 5)
+constexpr const_table_t<int, 25> make_pi_index() {
+    const_table_t<int, 25> r{};
+    for (int i = 0; i < 25; i++)
+        r.v[i] = i / 5 + 5 * ((2 * (i % 5) + 3 * (i / 5)) % 5);
+    return r;
+}
+
+constexpr const_table_t<uint64_t, 24> RC = make_keccak_rc();
+constexpr const_table_t<int, 25> rho_offsets = make_rho_offsets();
+constexpr const_table_t<int, 25> pi_index = make_pi_index();
+
+static_assert(RC[0] == 0x0000000000000001ULL && RC[1] == 0x0000000000008082ULL &&
+              RC[2] == 0x800000000000808AULL && RC[23] == 0x8000000080008008ULL, "Keccak RC mismatch");
+static_assert(rho_offsets[0] == 0 && rho_offsets[1] == 1 && rho_offsets[2] == 62 &&
+              rho_offsets[10] == 3 && rho_offsets[24] == 14, "Keccak rho offsets mismatch");
+static_assert(pi_index[0] == 0 && pi_index[1] == 10 && pi_index[5] == 16 &&
+              pi_index[24] == 4, "Keccak pi permutation mismatch");
+
+// One Keccak-f[1600] round on a fully partitioned state
+static void keccak_round(lane_t state[25], int round) {
+#pragma HLS INLINE
     lane_t C[5], D[5], B[25];
 #pragma HLS ARRAY_PARTITION variable=C complete
 #pragma HLS ARRAY_PARTITION variable=D complete
 #pragma HLS ARRAY_PARTITION variable=B complete
-    
-    // Round constants for Keccak-f[1600]
 
-    
-    for (int round = 0; round < 24; round++) {
-#pragma HLS LOOP_TRIPCOUNT min=24 max=24
-#pragma HLS PIPELINE II=1
-        
-        // Theta step
-        for (int x = 0; x < 5; x++) {
+    // Theta step
+    for (int x = 0; x < 5; x++) {
 #pragma HLS UNROLL
-            C[x] = state[x] ^ state[x + 5] ^ state[x + 10] ^ state[x + 15] ^ state[x + 20];
-        }
+        C[x] = state[x] ^ state[x + 5] ^ state[x + 10] ^ state[x + 15] ^ state[x + 20];
+    }
 
-        for (int x = 0; x < 5; x++) {
+    for (int x = 0; x < 5; x++) {
 #pragma HLS UNROLL
-            D[x] = C[(x + 4) % 5] ^ ((C[(x + 1) % 5] << 1) | (C[(x + 1) % 5] >> 63));
-        }
+        D[x] = C[(x + 4) % 5] ^ ((C[(x + 1) % 5] << 1) | (C[(x + 1) % 5] >> 63));
+    }
 
-        for (int x = 0; x < 5; x++) {
+    for (int x = 0; x < 5; x++) {
 #pragma HLS UNROLL
-            for (int y = 0; y < 5; y++) {
+        for (int y = 0; y < 5; y++) {
 #pragma HLS UNROLL
-                state[5 * y + x] ^= D[x];
-            }
+            state[5 * y + x] ^= D[x];
         }
+    }
 
+    // Rho and Pi steps
+    // (pi_index and rho_offsets are compile-time tables, so every lane
+    // is a fixed rewire)
+    for (int i = 0; i < 25; i++) {
+    #pragma HLS UNROLL
+        int rho_offset = rho_offsets[i];
 
-
-        // Rho and Pi steps
-        for (int i = 0; i < 25; i++) {
-        #pragma HLS UNROLL
-            int x = i % 5;
-            int y = i / 5;
-            
-            // Pi mapping
-            int new_x = y;
-            int new_y = (2 * x + 3 * y) % 5;
-            int pi_index = new_x + 5 * new_y;
-
-            // Rho offset
-            int rho_offset = rho_offsets[i];
-
-            if (rho_offset == 0) {
-                B[pi_index] = state[i];
-            } else {
-                B[pi_index] = (state[i] << rho_offset) | (state[i] >> (64 - rho_offset));
-            }
+        if (rho_offset == 0) {
+            B[pi_index[i]] = state[i];
+        } else {
+            B[pi_index[i]] = (state[i] << rho_offset) | (state[i] >> (64 - rho_offset));
         }
+    }
 
-
-        // Chi step
-        for (int y = 0; y < 5; y++) {
+    // Chi step
+    for (int y = 0; y < 5; y++) {
 #pragma HLS UNROLL
-            for (int x = 0; x < 5; x++) {
+        for (int x = 0; x < 5; x++) {
 #pragma HLS UNROLL
-                state[5 * y + x] = B[5 * y + x] ^ ((~B[5 * y + (x + 1) % 5]) & B[5 * y + (x + 2) % 5]);
-            }
+            state[5 * y + x] = B[5 * y + x] ^ ((~B[5 * y + (x + 1) % 5]) & B[5 * y + (x + 2) % 5]);
         }
+    }
 
+    // Iota step
+    state[0] ^= RC[round];
+}
 
-        
-        // Iota step
-        state[0] ^= RC[round];
+void keccak_f1600(lane_t state[25]) {
+#pragma HLS INLINE off
+#pragma HLS ARRAY_PARTITION variable=state complete
 
+    for (int round = 0; round < 24; round++) {
+#pragma HLS LOOP_TRIPCOUNT min=24 max=24
+        HLS_PRAGMA(HLS PIPELINE II=KECCAK_ROUND_II)
+        CT_TRIP();
+        keccak_round(state, round);
     }
 }
-// SHA3-256 hash function
-void shake256(const byte_t* input, int input_len, byte_t* output, int output_len) {
-#pragma HLS INTERFACE m_axi port=input offset=slave bundle=gmem0
-#pragma HLS INTERFACE m_axi port=output offset=slave bundle=gmem1
-#pragma HLS INTERFACE s_axilite port=input_len bundle=control
-#pragma HLS INTERFACE s_axilite port=output_len bundle=control
-#pragma HLS INTERFACE s_axilite port=return bundle=control
 
-    lane_t state[25];
-#pragma HLS ARRAY_PARTITION variable=state complete
-    
-    // Initialize state
+// KECCAK_STATES independent permutations through one round datapath.
+// Round r of state s issues at step r * KECCAK_STATES + s, so a state's
+// next round is KECCAK_STATES issues after its previous one and the round
+// logic can be pipelined that deep without stalling.
+void keccak_f1600_interleaved(lane_t state[KECCAK_STATES][25]) {
+#pragma HLS INLINE off
+#pragma HLS ARRAY_PARTITION variable=state complete dim=2
+
+    for (int step = 0; step < 24 * KECCAK_STATES; step++) {
+        HLS_PRAGMA(HLS PIPELINE II=KECCAK_ROUND_II)
+        HLS_PRAGMA(HLS DEPENDENCE variable=state inter distance=KECCAK_STATES true)
+        int s = step % KECCAK_STATES;
+        lane_t lanes[25];
+#pragma HLS ARRAY_PARTITION variable=lanes complete
+        for (int i = 0; i < 25; i++) {
+#pragma HLS UNROLL
+            lanes[i] = state[s][i];
+        }
+        keccak_round(lanes, step / KECCAK_STATES);
+        for (int i = 0; i < 25; i++) {
+#pragma HLS UNROLL
+            state[s][i] = lanes[i];
+        }
+    }
+}
+
+// Shared sponge absorb: every full RATE-byte block of input is XORed in a
+// lane per cycle and permuted, then the tail is padded with the domain
+// separation byte dsep (0x06 SHA3, 0x1f SHAKE) and the final 0x80 and
+// absorbed the same way. Inputs of any length, so any number of blocks.
+template <int RATE>
+static void keccak_absorb(lane_t state[25], const byte_t* input, int input_len, byte_t dsep) {
+#pragma HLS INLINE
     for (int i = 0; i < 25; i++) {
 #pragma HLS UNROLL
         state[i] = 0;
     }
-    
-    // Absorbing phase
+
     int pos = 0;
-    
+
     // Process full blocks
-    while (pos + SHAKE256_RATE <= input_len) {
+    while (pos + RATE <= input_len) {
 #pragma HLS LOOP_TRIPCOUNT min=1 max=10
-        
+
         // XOR input block into state
-        for (int i = 0; i < SHAKE256_RATE; i += 8) {
+        for (int i = 0; i < RATE; i += 8) {
 #pragma HLS PIPELINE II=1
             lane_t block_word = 0;
-            for (int j = 0; j < 8 && (i + j) < SHAKE256_RATE; j++) {
+            for (int j = 0; j < 8; j++) {
 #pragma HLS UNROLL
                 block_word |= (lane_t)input[pos + i + j] << (8 * j);
             }
             state[i / 8] ^= block_word;
+            CT_TRIP();
         }
-        
+
         keccak_f1600(state);
-        pos += SHAKE256_RATE;
+        pos += RATE;
     }
-    
+
     // Process remaining bytes and padding
-    byte_t last_block[SHAKE256_RATE];
-#pragma HLS ARRAY_PARTITION variable=last_block complete
-    
-    // Copy remaining input bytes
     int remaining = input_len - pos;
-    for (int i = 0; i < remaining; i++) {
-#pragma HLS UNROLL
-        last_block[i] = input[pos + i];
-    }
-    
-    // Add padding (0x1f for SHAKE256)
-    last_block[remaining] = 0x1f;
-    for (int i = remaining + 1; i < SHAKE256_RATE - 1; i++) {
-#pragma HLS UNROLL
-        last_block[i] = 0;
-    }
-    last_block[SHAKE256_RATE - 1] = 0x80;
-    
-    // XOR last block into state
-    for (int i = 0; i < SHAKE256_RATE; i += 8) {
+    for (int i = 0; i < RATE; i += 8) {
 #pragma HLS PIPELINE II=1
         lane_t block_word = 0;
         for (int j = 0; j < 8; j++) {
 #pragma HLS UNROLL
-            block_word |= (lane_t)last_block[i + j] << (8 * j);
+            byte_t b = (i + j < remaining) ? input[pos + i + j] : (byte_t)0;
+            if (i + j == remaining)
+                b ^= dsep;
+            if (i + j == RATE - 1)
+                b ^= 0x80;
+            block_word |= (lane_t)b << (8 * j);
         }
         state[i / 8] ^= block_word;
+        CT_TRIP();
     }
-    
+
     keccak_f1600(state);
+}
+
+// SHA3-256 hash function
+void shake256(const byte_t* input, int input_len, byte_t* output, int output_len) {
+#pragma HLS INTERFACE m_axi port=input offset=slave bundle=gmem0
+#pragma HLS INTERFACE m_axi port=output offset=slave bundle=gmem1
+#pragma HLS INTERFACE s_axilite port=input_len bundle=control
+#pragma HLS INTERFACE s_axilite port=output_len bundle=control
+#pragma HLS INTERFACE s_axilite port=return bundle=control
+
+    lane_t state[25];
+#pragma HLS ARRAY_PARTITION variable=state complete
+
+    keccak_absorb<SHAKE256_RATE>(state, input, input_len, 0x1f);
     
     // Squeezing phase
     int output_pos = 0;
@@ -175,6 +229,7 @@ void shake256(const byte_t* input, int input_len, byte_t* output, int output_len
         for (int i = 0; i < extract_len; i += 8) {
 #pragma HLS PIPELINE II=1
             lane_t lane_data = state[i / 8];
+            CT_TRIP();
             for (int j = 0; j < 8 && (i + j) < extract_len; j++) {
 #pragma HLS UNROLL
                 output[output_pos + i + j] = (byte_t)(lane_data >> (8 * j));
@@ -198,67 +253,8 @@ void sha3_256(const byte_t* input, int input_len, byte_t output[32]) {
 
     lane_t state[25];
 #pragma HLS ARRAY_PARTITION variable=state complete
-    
-    // Initialize state
-    for (int i = 0; i < 25; i++) {
-#pragma HLS UNROLL
-        state[i] = 0;
-    }
-    
-    // Absorbing phase (similar to SHAKE256 but with different rate)
-    int rate = 136; // SHA3-256 rate
-    int pos = 0;
-    
-    // Process full blocks
-    while (pos + rate <= input_len) {
-#pragma HLS LOOP_TRIPCOUNT min=1 max=10
-        
-        // XOR input block into state
-        for (int i = 0; i < rate; i += 8) {
-#pragma HLS PIPELINE II=1
-            lane_t block_word = 0;
-            for (int j = 0; j < 8 && (i + j) < rate; j++) {
-#pragma HLS UNROLL
-                block_word |= (lane_t)input[pos + i + j] << (8 * j);
-            }
-            state[i / 8] ^= block_word;
-        }
-        
-        keccak_f1600(state);
-        pos += rate;
-    }
-    
-    // Process remaining bytes and padding
-    byte_t last_block[136];
-#pragma HLS ARRAY_PARTITION variable=last_block complete
-    
-    // Copy remaining input bytes
-    int remaining = input_len - pos;
-    for (int i = 0; i < remaining; i++) {
-#pragma HLS UNROLL
-        last_block[i] = input[pos + i];
-    }
-    
-    // Add padding (0x06 for SHA3-256)
-    last_block[remaining] = 0x06;
-    for (int i = remaining + 1; i < rate - 1; i++) {
-#pragma HLS UNROLL
-        last_block[i] = 0;
-    }
-    last_block[rate - 1] = 0x80;
-    
-    // XOR last block into state
-    for (int i = 0; i < rate; i += 8) {
-#pragma HLS PIPELINE II=1
-        lane_t block_word = 0;
-        for (int j = 0; j < 8; j++) {
-#pragma HLS UNROLL
-            block_word |= (lane_t)last_block[i + j] << (8 * j);
-        }
-        state[i / 8] ^= block_word;
-    }
-    
-    keccak_f1600(state);
+
+    keccak_absorb<SHA3_256_RATE>(state, input, input_len, 0x06);
     
     // Extract 256 bits (32 bytes)
     for (int i = 0; i < 32; i += 8) {
@@ -271,64 +267,40 @@ void sha3_256(const byte_t* input, int input_len, byte_t output[32]) {
     }
 }
 
-void sha3_512(const byte_t* input, int input_len, byte_t output[64]) {
-#pragma HLS INTERFACE m_axi port=input offset=slave bundle=gmem0
-#pragma HLS INTERFACE m_axi port=output offset=slave bundle=gmem1
-#pragma HLS INTERFACE s_axilite port=input_len bundle=control
-#pragma HLS INTERFACE s_axilite port=return bundle=control
-
-    lane_t state[25];
-#pragma HLS ARRAY_PARTITION variable=state complete
-
-    // Initialize state to zero
+// Incremental SHA3-256: zero state
+void sha3_256_init(lane_t state[25]) {
+#pragma HLS INLINE
     for (int i = 0; i < 25; i++) {
 #pragma HLS UNROLL
         state[i] = 0;
     }
+}
 
-    const int rate = 72; // 72 bytes = 576 bits for SHA3-512
-    int pos = 0;
-
-    // Final block and padding
-    byte_t last_block[rate];
-#pragma HLS ARRAY_PARTITION variable=last_block complete
-
-    // 1. Zero the block
-    for (int i = 0; i < rate; i++) {
-#pragma HLS UNROLL
-        last_block[i] = 0;
-    }
+// Incremental SHA3-256: pad a message of whole lanes that ends `lane` lanes
+// into the current block, run the last permutation and squeeze the digest
+// as four 64-bit beats
+void sha3_256_final_beats(lane_t state[25], int lane, beat_t output[4]) {
+#pragma HLS INLINE
+    state[lane] ^= (lane_t)0x06;
+    state[SHA3_256_RATE_LANES - 1] ^= (lane_t)0x80 << 56;
+    keccak_f1600(state);
 
-    // 2. Copy remaining bytes
-    int remaining = input_len - pos;
-    for (int i = 0; i < remaining; i++) {
+    for (int i = 0; i < 4; i++) {
 #pragma HLS UNROLL
-        last_block[i] = input[pos + i];
+        output[i] = state[i];
     }
- 
-
-    // 3. Padding: 0x06 and 0x80
-    last_block[remaining] ^= 0x06;
-    last_block[rate - 1] ^= 0x80;
+}
 
+void sha3_512(const byte_t* input, int input_len, byte_t output[64]) {
+#pragma HLS INTERFACE m_axi port=input offset=slave bundle=gmem0
+#pragma HLS INTERFACE m_axi port=output offset=slave bundle=gmem1
+#pragma HLS INTERFACE s_axilite port=input_len bundle=control
+#pragma HLS INTERFACE s_axilite port=return bundle=control
 
+    lane_t state[25];
+#pragma HLS ARRAY_PARTITION variable=state complete
 
-    // 4. Absorb final padded block
-    for (int i = 0; i < rate; i += 8) {
-#pragma HLS PIPELINE II=1
-        ap_uint<64> block_word = 0;
-        for (int j = 0; j < 8; j++) {
-#pragma HLS UNROLL
-            block_word |= (ap_uint<64>)last_block[i + j] << (8 * j);
-        }
-        
-    // Compute original linear index
-    int idx = i / 8;
-    state[idx] ^= block_word;
-         //printf("\n");
-    }
-          
-    keccak_f1600(state);
+    keccak_absorb<SHA3_512_RATE>(state, input, input_len, 0x06);
 
     // Extract 64 bytes (SHA3-512)
     for (int i = 0; i < 64; i++) {
@@ -351,66 +323,8 @@ void shake128(const byte_t* input, int input_len, byte_t* output, int output_len
 
     lane_t state[25];
 #pragma HLS ARRAY_PARTITION variable=state complete
-    
-    // Initialize state
-    for (int i = 0; i < 25; i++) {
-#pragma HLS UNROLL
-        state[i] = 0;
-    }
-    
-    // Absorbing phase
-    int pos = 0;
-    
-    // Process full blocks
-    while (pos + SHAKE128_RATE <= input_len) {
-#pragma HLS LOOP_TRIPCOUNT min=1 max=10
-        
-        // XOR input block into state
-        for (int i = 0; i < SHAKE128_RATE; i += 8) {
-#pragma HLS PIPELINE II=1
-            lane_t block_word = 0;
-            for (int j = 0; j < 8 && (i + j) < SHAKE128_RATE; j++) {
-#pragma HLS UNROLL
-                block_word |= (lane_t)input[pos + i + j] << (8 * j);
-            }
-            state[i / 8] ^= block_word;
-        }
-        
-        keccak_f1600(state);
-        pos += SHAKE128_RATE;
-    }
-    
-    // Process remaining bytes and padding
-    byte_t last_block[SHAKE128_RATE];
-#pragma HLS ARRAY_PARTITION variable=last_block complete
-    
-    // Copy remaining input bytes
-    int remaining = input_len - pos;
-    for (int i = 0; i < remaining; i++) {
-#pragma HLS UNROLL
-        last_block[i] = input[pos + i];
-    }
-    
-    // Add padding (0x1f for SHAKE128)
-    last_block[remaining] = 0x1f;
-    for (int i = remaining + 1; i < SHAKE128_RATE - 1; i++) {
-#pragma HLS UNROLL
-        last_block[i] = 0;
-    }
-    last_block[SHAKE128_RATE - 1] = 0x80;
-    
-    // XOR last block into state
-    for (int i = 0; i < SHAKE128_RATE; i += 8) {
-#pragma HLS PIPELINE II=1
-        lane_t block_word = 0;
-        for (int j = 0; j < 8; j++) {
-#pragma HLS UNROLL
-            block_word |= (lane_t)last_block[i + j] << (8 * j);
-        }
-        state[i / 8] ^= block_word;
-    }
-    
-    keccak_f1600(state);
+
+    keccak_absorb<SHAKE128_RATE>(state, input, input_len, 0x1f);
     
     // Squeezing phase
     int output_pos = 0;
@@ -425,6 +339,7 @@ void shake128(const byte_t* input, int input_len, byte_t* output, int output_len
         for (int i = 0; i < extract_len; i += 8) {
 #pragma HLS PIPELINE II=1
             lane_t lane_data = state[i / 8];
+            CT_TRIP();
             for (int j = 0; j < 8 && (i + j) < extract_len; j++) {
 #pragma HLS UNROLL
                 output[output_pos + i + j] = (byte_t)(lane_data >> (8 * j));
@@ -440,6 +355,30 @@ void shake128(const byte_t* input, int input_len, byte_t* output, int output_len
     }
 }
 
+// Incremental SHAKE128: absorb once, then squeeze one block per call
+void shake128_absorb(lane_t state[25], const byte_t* input, int input_len) {
+#pragma HLS INLINE
+    keccak_absorb<SHAKE128_RATE>(state, input, input_len, 0x1f);
+}
+
+// The first block after absorbing is read as is, every later one after a
+// permutation
+void shake128_squeeze_block(lane_t state[25], bool first, byte_t output[SHAKE128_RATE]) {
+#pragma HLS INLINE
+    if (!first)
+        keccak_f1600(state);
+
+    for (int i = 0; i < SHAKE128_RATE; i += 8) {
+#pragma HLS PIPELINE II=1
+        lane_t lane_data = state[i / 8];
+        CT_TRIP();
+        for (int j = 0; j < 8; j++) {
+#pragma HLS UNROLL
+            output[i + j] = (byte_t)(lane_data >> (8 * j));
+        }
+    }
+}
+
 void G(const byte_t* input, int input_len, byte_t output[64]) {
 #pragma HLS INLINE off
     sha3_512(input, input_len, output);
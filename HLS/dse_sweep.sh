@@ -0,0 +1,168 @@
+#!/bin/bash
+# Design-space sweep of mlkem512_keygen_top over a parameter grid, with the
+# results harvested into a Pareto table in reports/dse_sweep.md.
+#
+# Grid (space-separated lists from the environment):
+#   CLOCKS     clock target in MHz                          (default: 100 150 200)
+#   KECCAK_II  KECCAK_ROUND_II, cycles per Keccak round     (default: 1 2)
+#   BANKS      POLY_BANKS: NTT butterflies per iteration    (default: 4 8 16)
+#   NTT        0 = in-place banked NTT, P = streaming NTT
+#              with NTT_STREAM_LANES=P                      (default: 0 4)
+#
+# Every point gets its own hls_config.cfg variant and a C simulation with
+# CT_SEEDS=20. The per-stage trip counts that test_fixed_latency prints are
+# the cycle-estimation hook: each trip is one pipeline iteration or Keccak
+# round, so
+#     cycles ~ sum over stages of trips * II
+# with II = KECCAK_ROUND_II for the Keccak-bound stages (G, PRF), 2 for the
+# banked NTT, 1 elsewhere, and the streaming NTT's 7 concurrent layers
+# counted once. Matrix expansion takes its worst seed. Loop fill and control
+# overhead are not included.
+#
+# With v++ on PATH each point is also synthesized, and the top-level row of
+# its hls_compile.rpt supplies slack, II and resources, and the latency if
+# the report resolves it. Without Vitis (or with DSE_LOCAL=1) csim is a
+# plain g++ build against AP_INCLUDE, run once per point of the non-clock
+# parameters; slack and resources are left empty and every clock target is
+# assumed met.
+#
+# keys/s = f_clk / latency (one core, one keypair at a time). A point is
+# Pareto-optimal (*) if no other point is at least as good in latency (ns),
+# LUT, FF, DSP and BRAM and better in one; missing resources compare equal.
+#
+# Usage: [CLOCKS=..] [KECCAK_II=..] [BANKS=..] [NTT=..] ./dse_sweep.sh
+# Local mode needs g++ and ap_int.h (set XILINX_HLS or AP_INCLUDE).
+
+set -e -o pipefail
+cd "$(dirname "$0")"
+
+CLOCKS=${CLOCKS:-100 150 200}
+KECCAK_II=${KECCAK_II:-1 2}
+BANKS=${BANKS:-4 8 16}
+NTT=${NTT:-0 4}
+XILINX_HLS=${XILINX_HLS:-/tools/Xilinx/Vitis_HLS/2024.1}
+AP_INCLUDE=${AP_INCLUDE:-$XILINX_HLS/include}
+CXX=${CXX:-g++}
+OUT=../reports/dse_sweep.md
+ROWS=dse_rows.tsv
+
+LOCAL=${DSE_LOCAL:-0}
+command -v v++ > /dev/null && command -v vitis-run > /dev/null || LOCAL=1
+
+SYN_SRCS=$(sed -n 's/^syn.file=\(.*\.cpp\)/\1/p' hls_config.cfg)
+TB_SRCS=$(sed -n 's/^tb.file=\(.*\.cpp\)/\1/p' hls_config.cfg)
+
+# Trip-count estimate from a csim log: stage lines are "name: lo [.. hi]"
+csim_cycles() {
+    sed -n '/Testing fixed latency/,/PASS\|FAIL/p' "$1" | awk -v kii="$2" -v ntt="$3" '
+        $1 ~ /:$/ {
+            name = substr($1, 1, length($1) - 1)
+            trips = ($3 == "..") ? $4 : $2
+            ii = 1
+            if (name == "G" || name == "PRF") ii = kii
+            if (name == "NTT") ii = ntt ? 1 / 7 : 2
+            cycles += trips * ii
+        }
+        END { printf "%.0f", cycles }'
+}
+
+declare -A CSIM_DONE
+: > "$ROWS"
+for f in $CLOCKS; do
+for kii in $KECCAK_II; do
+for banks in $BANKS; do
+for ntt in $NTT; do
+    [ "$ntt" -le "$banks" ] || continue
+    tag=${f}MHz_k${kii}_b${banks}_n${ntt}
+    work=dse_$tag
+    cfg=hls_config_dse_$tag.cfg
+    log=dse_k${kii}_b${banks}_n${ntt}.csim.log
+    flags="-DKECCAK_ROUND_II=$kii -DPOLY_BANKS=$banks"
+    [ "$ntt" -eq 0 ] || flags="$flags -DNTT_STREAMING=1 -DNTT_STREAM_LANES=$ntt"
+
+    # hls_config.cfg has no trailing newline: terminate it before appending
+    { sed "s/^clock=.*/clock=${f}MHz/" hls_config.cfg; echo; } > "$cfg"
+    echo "syn.cflags=$flags" >> "$cfg"
+    echo "tb.cflags=$flags -DCT_SEEDS=20" >> "$cfg"
+
+    slack=- ii=- bram=- dsp=- ff=- lut=- src=csim
+    # A point whose csim fails (any main_test check, not only the trip
+    # counts) is left out of the table
+    if [ "$LOCAL" = 1 ]; then
+        if [ -z "${CSIM_DONE[$log]}" ]; then
+            $CXX -std=c++14 -O2 -w $flags -DCT_SEEDS=20 -I"$AP_INCLUDE" -I. $SYN_SRCS $TB_SRCS -o dse_csim.tb
+            CSIM_DONE[$log]=PASS
+            ./dse_csim.tb > "$log" || CSIM_DONE[$log]=FAIL
+        fi
+        csim=${CSIM_DONE[$log]}
+    else
+        csim=PASS
+        vitis-run --mode hls --csim --config "$cfg" --work_dir "$work" | tee "$log" || csim=FAIL
+    fi
+    if [ "$csim" = FAIL ]; then
+        echo "dse_sweep: csim failed for $tag (see $log), point skipped" >&2
+        continue
+    fi
+    [ "$LOCAL" = 1 ] || v++ -c --mode hls --config "$cfg" --work_dir "$work"
+    cycles=$(csim_cycles "$log" "$kii" "$ntt")
+
+    rpt=$(find "$work" -name hls_compile.rpt -o -name csynth.rpt 2>/dev/null | head -1) || true
+    if [ -n "$rpt" ]; then
+        # | + top | Issue | Slack | Lat cyc | Lat ns | Iter | II | Trip | Pipe | BRAM | DSP | FF | LUT | URAM |
+        read -r slack lat ii bram dsp ff lut < <(grep -m1 "+ mlkem512_keygen_top " "$rpt" | awk -F'|' '
+            function num(s) { gsub(/^ +| +$/, "", s); sub(/ *\(.*/, "", s); return s == "" ? "-" : s }
+            { print num($4), num($5), num($8), num($11), num($12), num($13), num($14) }') || true
+        if [ -z "$slack" ]; then
+            echo "dse_sweep: no mlkem512_keygen_top row in $rpt, resources left empty" >&2
+            slack=- lat=- ii=- bram=- dsp=- ff=- lut=-
+        fi
+        if [[ "$lat" =~ ^[0-9]+$ ]]; then
+            cycles=$lat
+            src=rpt
+        fi
+    fi
+    [ "$ii" != "-" ] || ii=$cycles
+
+    printf "%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\n" \
+        "$f" "$kii" "$banks" "$ntt" "$slack" "$cycles" "$src" "$ii" "$lut" "$ff" "$dsp" "$bram" >> "$ROWS"
+done
+done
+done
+done
+
+mkdir -p ../reports
+awk -F'\t' '
+    function val(s) { return s == "-" ? 0 : s + 0 }
+    # a dominates b: no worse in every objective, better in one
+    function dominates(a, b,    k, better) {
+        better = 0
+        for (k = 1; k <= 5; k++) {
+            if (obj[a, k] > obj[b, k]) return 0
+            if (obj[a, k] < obj[b, k]) better = 1
+        }
+        return better
+    }
+    {
+        row[NR] = $0
+        ns = $6 * 1000 / $1
+        obj[NR, 1] = ns
+        obj[NR, 2] = val($9); obj[NR, 3] = val($10); obj[NR, 4] = val($11); obj[NR, 5] = val($12)
+        lat_ns[NR] = ns
+        rate[NR] = $6 > 0 ? $1 * 1e6 / $6 : 0
+    }
+    END {
+        print "| Pareto | Clock (MHz) | Keccak II | Banks | NTT | Slack (ns) | Latency (cycles) | Source | Latency (us) | II | LUT | FF | DSP | BRAM | Est. keys/s |"
+        print "|--------|-------------|-----------|-------|-----|------------|------------------|--------|--------------|----|-----|----|-----|------|-------------|"
+        for (i = 1; i <= NR; i++) {
+            pareto = "*"
+            for (j = 1; j <= NR; j++)
+                if (j != i && dominates(j, i)) { pareto = ""; break }
+            split(row[i], c, "\t")
+            printf "| %s | %s | %s | %s | %s | %s | %s | %s | %.1f | %s | %s | %s | %s | %s | %.0f |\n",
+                   pareto, c[1], c[2], c[3], c[4] == 0 ? "banked" : "stream x" c[4], c[5], c[6], c[7],
+                   lat_ns[i] / 1000, c[8], c[9], c[10], c[11], c[12], rate[i]
+        }
+    }' "$ROWS" > "$OUT"
+rm -f dse_csim.tb
+
+cat "$OUT"
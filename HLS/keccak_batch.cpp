@@ -0,0 +1,167 @@
+#include "unified.h"
+
+// Batched SHA3/SHAKE accelerator.
+//
+// Up to KECCAK_STATES descriptors are in flight at once, one sponge each.
+// Every step, each sponge either absorbs its next input block, squeezes its
+// next output block or sits out; then all states are permuted together by
+// keccak_f1600_interleaved. A group ends when every sponge has written all
+// of its output, and the next KECCAK_STATES descriptors are loaded.
+
+enum keccak_phase_t { KECCAK_ABSORB, KECCAK_SQUEEZE, KECCAK_DONE };
+
+struct keccak_job_t {
+    int in_beat;        // Next input beat
+    int in_left;        // Input bytes not absorbed yet
+    int out_beat;       // Next output beat
+    int out_left;       // Output bytes not squeezed yet
+    int rate_lanes;
+    byte_t dsep;
+    keccak_phase_t phase;
+};
+
+// Low n bytes of a lane (n >= 8: all of it)
+static lane_t lane_low_bytes(lane_t w, int n) {
+#pragma HLS INLINE
+    return n >= 8 ? w : (lane_t)(w & (((lane_t)1 << (8 * n)) - 1));
+}
+
+// Decode one descriptor; returns false for an unknown mode
+static bool keccak_job_load(const beat_t* desc, int n, keccak_job_t& job) {
+#pragma HLS INLINE
+    beat_t d0 = desc[n * KECCAK_DESC_BEATS];
+    beat_t d1 = desc[n * KECCAK_DESC_BEATS + 1];
+    int mode = (int)(d1 >> 56);
+    int out_len = (int)((d1 >> 32) & 0xffffff);
+
+    job.in_beat = (int)(d0 & 0xffffffff) / 8;
+    job.in_left = (int)(d0 >> 32);
+    job.out_beat = (int)(d1 & 0xffffffff) / 8;
+    job.phase = KECCAK_ABSORB;
+
+    switch (mode) {
+    case KECCAK_MODE_SHA3_256:
+        job.rate_lanes = SHA3_256_RATE / 8;
+        job.dsep = 0x06;
+        job.out_left = out_len < 32 ? out_len : 32;
+        return true;
+    case KECCAK_MODE_SHA3_512:
+        job.rate_lanes = SHA3_512_RATE / 8;
+        job.dsep = 0x06;
+        job.out_left = out_len < 64 ? out_len : 64;
+        return true;
+    case KECCAK_MODE_SHAKE128:
+        job.rate_lanes = SHAKE128_RATE / 8;
+        job.dsep = 0x1f;
+        job.out_left = out_len;
+        return true;
+    case KECCAK_MODE_SHAKE256:
+        job.rate_lanes = SHAKE256_RATE / 8;
+        job.dsep = 0x1f;
+        job.out_left = out_len;
+        return true;
+    default:
+        job.phase = KECCAK_DONE;
+        return false;
+    }
+}
+
+// XOR the next input block into a sponge, padding it if it is the last
+static void keccak_job_absorb(lane_t state[25], keccak_job_t& job, const beat_t* in) {
+#pragma HLS INLINE
+    int rate = job.rate_lanes * 8;
+    bool last = job.in_left < rate;
+
+    for (int i = 0; i < SHAKE128_RATE / 8; i++) {
+#pragma HLS PIPELINE II=1
+        if (i < job.rate_lanes) {
+            int have = job.in_left - 8 * i;
+            lane_t w = have > 0 ? lane_low_bytes(in[job.in_beat + i], have) : (lane_t)0;
+            if (last && have >= 0 && have < 8)
+                w ^= (lane_t)job.dsep << (8 * have);
+            if (last && i == job.rate_lanes - 1)
+                w ^= (lane_t)0x80 << 56;
+            state[i] ^= w;
+        }
+    }
+
+    if (last) {
+        job.phase = KECCAK_SQUEEZE;
+    } else {
+        job.in_beat += job.rate_lanes;
+        job.in_left -= rate;
+    }
+}
+
+// Write the next output block of a sponge; true if more output is needed
+static bool keccak_job_squeeze(const lane_t state[25], keccak_job_t& job, beat_t* out) {
+#pragma HLS INLINE
+    int rate = job.rate_lanes * 8;
+    int n = job.out_left < rate ? job.out_left : rate;
+
+    for (int i = 0; i < SHAKE128_RATE / 8; i++) {
+#pragma HLS PIPELINE II=1
+        if (8 * i < n)
+            out[job.out_beat + i] = lane_low_bytes(state[i], n - 8 * i);
+    }
+
+    job.out_beat += job.rate_lanes;
+    job.out_left -= n;
+    if (job.out_left == 0) {
+        job.phase = KECCAK_DONE;
+        return false;
+    }
+    return true;
+}
+
+int keccak_batch_top(const beat_t* desc, int ndesc, const beat_t* in, beat_t* out) {
+#pragma HLS INTERFACE m_axi port=desc offset=slave bundle=gmem0 depth=64
+#pragma HLS INTERFACE m_axi port=in offset=slave bundle=gmem1 depth=4096
+#pragma HLS INTERFACE m_axi port=out offset=slave bundle=gmem2 depth=4096
+#pragma HLS INTERFACE s_axilite port=desc bundle=control
+#pragma HLS INTERFACE s_axilite port=ndesc bundle=control
+#pragma HLS INTERFACE s_axilite port=in bundle=control
+#pragma HLS INTERFACE s_axilite port=out bundle=control
+#pragma HLS INTERFACE s_axilite port=return bundle=control
+
+    lane_t state[KECCAK_STATES][25];
+    keccak_job_t job[KECCAK_STATES];
+#pragma HLS ARRAY_PARTITION variable=state complete dim=2
+#pragma HLS ARRAY_PARTITION variable=job complete
+    int rejected = 0;
+
+    for (int base = 0; base < ndesc; base += KECCAK_STATES) {
+#pragma HLS LOOP_TRIPCOUNT min=1 max=8
+        for (int s = 0; s < KECCAK_STATES; s++) {
+            for (int i = 0; i < 25; i++) {
+#pragma HLS UNROLL
+                state[s][i] = 0;
+            }
+            if (base + s < ndesc) {
+                if (!keccak_job_load(desc, base + s, job[s]))
+                    rejected++;
+            } else {
+                job[s].phase = KECCAK_DONE;
+            }
+        }
+
+        // One block per sponge per step, then a shared permutation
+        bool busy = true;
+        while (busy) {
+#pragma HLS LOOP_TRIPCOUNT min=2 max=16
+            busy = false;
+            for (int s = 0; s < KECCAK_STATES; s++) {
+                if (job[s].phase == KECCAK_SQUEEZE) {
+                    busy |= keccak_job_squeeze(state[s], job[s], out);
+                } else if (job[s].phase == KECCAK_ABSORB) {
+                    keccak_job_absorb(state[s], job[s], in);
+                    busy = true;
+                }
+            }
+            if (busy)
+                keccak_f1600_interleaved(state);
+        }
+    }
+
+    return rejected;
+}
@@ -43,12 +43,10 @@ void print_matrix(const matrix_t A) {
     }
 }*/
 
-void mlkem512_keygen_top(const byte_t d[32],const byte_t z[32], byte_t pk[MLKEM_PUBLICKEYBYTES], byte_t sk[MLKEM_SECRETKEYBYTES]) {
-#pragma HLS INTERFACE m_axi port=z offset=slave bundle=gmem0
-#pragma HLS INTERFACE m_axi port=d offset=slave bundle=gmem0
-#pragma HLS INTERFACE m_axi port=pk offset=slave bundle=gmem1
-#pragma HLS INTERFACE m_axi port=sk offset=slave bundle=gmem2
-#pragma HLS INTERFACE s_axilite port=return bundle=control
+// Key generation core: (d, z) -> (pk, sk). Shared by the single-core top
+// below and the replicated cores of mlkem512_keygen_multi_top.
+void mlkem512_keygen(const byte_t d[32],const byte_t z[32], beat_t pk[MLKEM_PUBLICKEYBEATS], beat_t sk[MLKEM_SECRETKEYBEATS]) {
+#pragma HLS INLINE off
 
     // Local variables
     byte_t buf[64];
@@ -62,6 +60,7 @@ void mlkem512_keygen_top(const byte_t d[32],const byte_t z[32], byte_t pk[MLKEM_
 #pragma HLS ARRAY_PARTITION variable=sigma complete
 
     // Step 1: (rho, sigma) := G(d)
+    CT_STAGE(CT_G);
     G(d, 32, buf);
 
     // Split the 64-byte output
@@ -72,7 +71,8 @@ void mlkem512_keygen_top(const byte_t d[32],const byte_t z[32], byte_t pk[MLKEM_
     }
 
     // Step 2: Generate matrix A from rho
-    matrix_expand(&A, rho);
+    CT_STAGE(CT_MATRIX);
+    matrix_expand(&A, rho, false);
 
 
 
@@ -80,10 +80,10 @@ void mlkem512_keygen_top(const byte_t d[32],const byte_t z[32], byte_t pk[MLKEM_
     byte_t prf_buf_s[MLKEM_K * 64 * MLKEM_ETA1];
     byte_t prf_buf_s1[64 * MLKEM_ETA1];
     byte_t prf_buf_s2[64 * MLKEM_ETA1];
-#pragma HLS ARRAY_PARTITION variable=prf_buf_s complete
+    BYTES_BANKED(prf_buf_s)
     
     // Generate PRF output for each polynomial in s
-    
+    CT_STAGE(CT_PRF);
     for (int i = 0; i < MLKEM_K; i++) {
 #pragma HLS UNROLL
         prf_eta(MLKEM_ETA1, sigma, (byte_t)i, prf_buf_s + i * 64 * MLKEM_ETA1);
@@ -91,67 +91,95 @@ void mlkem512_keygen_top(const byte_t d[32],const byte_t z[32], byte_t pk[MLKEM_
     prf_eta(MLKEM_ETA1, sigma, (byte_t)0, prf_buf_s1 );
     //prf_eta(MLKEM_ETA1, sigma, (byte_t)1, prf_buf_s2 );
 
+    CT_STAGE(CT_CBD);
     polyvec_cbd_eta1(&s_hat, prf_buf_s);
     
     // Step 4: Generate error vector e from sigma
     byte_t prf_buf_e[MLKEM_K * 64 * MLKEM_ETA1];
-#pragma HLS ARRAY_PARTITION variable=prf_buf_e complete
+    BYTES_BANKED(prf_buf_e)
     
     // Generate PRF output for each polynomial in e
+    CT_STAGE(CT_PRF);
     for (int i = 0; i < MLKEM_K; i++) {
 #pragma HLS UNROLL
         prf_eta(MLKEM_ETA1, sigma, (byte_t)(i + MLKEM_K), prf_buf_e + i * 64 * MLKEM_ETA1);
     }
     
     // Sample e using CBD
+    CT_STAGE(CT_CBD);
     polyvec_cbd_eta1(&e_hat, prf_buf_e);
     
     // Step 5: Transform s and e to NTT domain
-    
+    CT_STAGE(CT_NTT);
     polyvec_ntt(&s_hat);
 
     polyvec_ntt(&e_hat);
 
     // Step 6: Compute t = A * s + e
+    CT_STAGE(CT_BASEMUL);
     matrix_vector_mul(&pkpv, &A, &s_hat);
 
+    // Both terms are below q, so the sum comes out of polyvec_add already
+    // reduced and t needs no separate reduction pass
     polyvec_add(&pkpv, &pkpv, &e_hat);
-    
-    // Step 7: Reduce t modulo q
-    polyvec_reduce(&pkpv);
-    
 
-    polyvec_tobytes(pk, &pkpv);
+    // Serialize pk as 64-bit beats into a local buffer: t_hat || rho
+    CT_STAGE(CT_PACK);
+    beat_t pk_beats[MLKEM_PUBLICKEYBEATS];
+#pragma HLS ARRAY_PARTITION variable=pk_beats cyclic factor=3
+
+    polyvec_tobeats(pk_beats, &pkpv);
     //print_polyvec(pkpv);
-    for (int i = 0; i < 32; i++) {
-#pragma HLS UNROLL
-        pk[MLKEM_K * MLKEM_POLYBYTES + i] = rho[i];
-    }
-    
- 
-    polyvec_tobytes(sk, &s_hat);
-    
-    // Copy public key to secret key
-    for (int i = 0; i < MLKEM_PUBLICKEYBYTES; i++) {
+    bytes_tobeats(pk_beats + MLKEM_K * MLKEM_POLYBEATS, rho, MLKEM_SYMBEATS);
+
+    // Write pk and the pk copy inside sk as aligned beats, absorbing each
+    // beat into H(pk) on the way out: a beat is one little-endian Keccak
+    // lane, so every SHA3-256 block is permuted as soon as its 17th beat has
+    // been written and the hash is done one permutation after the last beat
+    lane_t h_state[25];
+#pragma HLS ARRAY_PARTITION variable=h_state complete
+    sha3_256_init(h_state);
+
+    for (int blk = 0; blk < PK_HASH_BLOCKS; blk++) {
+        for (int l = 0; l < SHA3_256_RATE_LANES; l++) {
 #pragma HLS PIPELINE II=1
-        sk[MLKEM_K * MLKEM_POLYBYTES + i] = pk[i];
+            int i = blk * SHA3_256_RATE_LANES + l;
+            CT_TRIP();
+            if (i < MLKEM_PUBLICKEYBEATS) {
+                beat_t w = pk_beats[i];
+                pk[i] = w;
+                sk[MLKEM_K * MLKEM_POLYBEATS + i] = w;
+                h_state[l] ^= w;
+            }
+        }
+        if (blk < PK_HASH_BLOCKS - 1)
+            keccak_f1600(h_state);
     }
-    
-    // Compute H(pk) and store in secret key
-    byte_t pk_hash[32];
+
+    polyvec_tobeats(sk, &s_hat);
+
+    // Pad, permute and store H(pk) in the secret key
+    beat_t pk_hash[MLKEM_SYMBEATS];
 #pragma HLS ARRAY_PARTITION variable=pk_hash complete
-    H(pk, MLKEM_PUBLICKEYBYTES, pk_hash);
-    
-    for (int i = 0; i < 32; i++) {
-#pragma HLS UNROLL
-        sk[MLKEM_K * MLKEM_POLYBYTES + MLKEM_PUBLICKEYBYTES + i] = pk_hash[i];
-    }
-    
+    sha3_256_final_beats(h_state, MLKEM_PUBLICKEYBEATS % SHA3_256_RATE_LANES, pk_hash);
 
-    for (int i = 0; i < 32; i++) {
-#pragma HLS UNROLL
-        sk[MLKEM_K * MLKEM_POLYBYTES + MLKEM_PUBLICKEYBYTES + 32 + i] = z[i];
+    for (int i = 0; i < MLKEM_SYMBEATS; i++) {
+#pragma HLS PIPELINE II=1
+        sk[MLKEM_K * MLKEM_POLYBEATS + MLKEM_PUBLICKEYBEATS + i] = pk_hash[i];
     }
+    bytes_tobeats(sk + MLKEM_K * MLKEM_POLYBEATS + MLKEM_PUBLICKEYBEATS + MLKEM_SYMBEATS, z, MLKEM_SYMBEATS);
 }
 
+void mlkem512_keygen_top(const byte_t d[32],const byte_t z[32], beat_t pk[MLKEM_PUBLICKEYBEATS], beat_t sk[MLKEM_SECRETKEYBEATS]) {
+#pragma HLS INTERFACE m_axi port=z offset=slave bundle=gmem0
+#pragma HLS INTERFACE m_axi port=d offset=slave bundle=gmem0
+#pragma HLS INTERFACE m_axi port=pk offset=slave bundle=gmem1
+#pragma HLS INTERFACE m_axi port=sk offset=slave bundle=gmem2
+#pragma HLS INTERFACE s_axilite port=d bundle=control
+#pragma HLS INTERFACE s_axilite port=z bundle=control
+#pragma HLS INTERFACE s_axilite port=pk bundle=control
+#pragma HLS INTERFACE s_axilite port=sk bundle=control
+#pragma HLS INTERFACE s_axilite port=return bundle=control
 
+    mlkem512_keygen(d, z, pk, sk);
+}
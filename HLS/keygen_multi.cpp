@@ -0,0 +1,110 @@
+#include "unified.h"
+#include "hls_stream.h"
+
+// Multi-core key generation IP.
+//
+// dispatch -> keygen_core x KEYGEN_CORES -> collect, as one dataflow region.
+// The dispatcher hands job n to core n % KEYGEN_CORES; each core owns its
+// own copy of the whole keygen datapath and exchanges data only through its
+// two streams. The collector drains cores in the same round-robin order, so
+// keypairs and completion-ring entries appear in job order.
+
+// Read (d, z) for every job and deal them out round-robin
+static void keygen_dispatch(const beat_t* jobs, int njobs, hls::stream<beat_t> job_s[KEYGEN_CORES]) {
+    int core = 0;
+    for (int n = 0; n < njobs; n++) {
+#pragma HLS LOOP_TRIPCOUNT min=1 max=64
+        for (int i = 0; i < KEYGEN_JOB_BEATS; i++) {
+#pragma HLS PIPELINE II=1
+            job_s[core].write(jobs[n * KEYGEN_JOB_BEATS + i]);
+        }
+        core = (core == KEYGEN_CORES - 1) ? 0 : core + 1;
+    }
+}
+
+// One replicated keygen core: its share of the jobs, one after another
+static void keygen_core(hls::stream<beat_t>& job_s, hls::stream<beat_t>& key_s, int njobs) {
+    for (int n = 0; n < njobs; n++) {
+#pragma HLS LOOP_TRIPCOUNT min=1 max=32
+        byte_t d[MLKEM_SYMBYTES], z[MLKEM_SYMBYTES];
+        beat_t pk[MLKEM_PUBLICKEYBEATS], sk[MLKEM_SECRETKEYBEATS];
+        beat_t seed[KEYGEN_JOB_BEATS];
+
+        for (int i = 0; i < KEYGEN_JOB_BEATS; i++) {
+#pragma HLS PIPELINE II=1
+            seed[i] = job_s.read();
+        }
+        beats_tobytes(d, seed, MLKEM_SYMBEATS);
+        beats_tobytes(z, seed + MLKEM_SYMBEATS, MLKEM_SYMBEATS);
+
+        mlkem512_keygen(d, z, pk, sk);
+
+        for (int i = 0; i < MLKEM_PUBLICKEYBEATS; i++) {
+#pragma HLS PIPELINE II=1
+            key_s.write(pk[i]);
+        }
+        for (int i = 0; i < MLKEM_SECRETKEYBEATS; i++) {
+#pragma HLS PIPELINE II=1
+            key_s.write(sk[i]);
+        }
+    }
+}
+
+// Write keypairs back in job order and post each job to the completion ring
+static void keygen_collect(hls::stream<beat_t> key_s[KEYGEN_CORES], int njobs,
+                           beat_t* keys, ap_uint<32>* done_ring, int ring_size) {
+    int core = 0;
+    int slot = 0;
+    for (int n = 0; n < njobs; n++) {
+#pragma HLS LOOP_TRIPCOUNT min=1 max=64
+        for (int i = 0; i < KEYGEN_KEY_BEATS; i++) {
+#pragma HLS PIPELINE II=1
+            keys[n * KEYGEN_KEY_BEATS + i] = key_s[core].read();
+        }
+#ifndef __SYNTHESIS__
+        // The threaded C model (driver mock) needs the same ordering
+        __sync_synchronize();
+#endif
+        done_ring[slot] = n + 1;
+        slot = (slot == ring_size - 1) ? 0 : slot + 1;
+        core = (core == KEYGEN_CORES - 1) ? 0 : core + 1;
+    }
+}
+
+static void keygen_multi_dataflow(const beat_t* jobs, beat_t* keys, ap_uint<32>* done_ring, int njobs, int ring_size) {
+#pragma HLS DATAFLOW
+
+    hls::stream<beat_t> job_s[KEYGEN_CORES];
+    hls::stream<beat_t> key_s[KEYGEN_CORES];
+#pragma HLS STREAM variable=job_s depth=16
+#pragma HLS STREAM variable=key_s depth=512
+
+    keygen_dispatch(jobs, njobs, job_s);
+
+    for (int c = 0; c < KEYGEN_CORES; c++) {
+#pragma HLS UNROLL
+        keygen_core(job_s[c], key_s[c], (njobs + KEYGEN_CORES - 1 - c) / KEYGEN_CORES);
+    }
+
+    keygen_collect(key_s, njobs, keys, done_ring, ring_size);
+}
+
+void mlkem512_keygen_multi_top(const beat_t* jobs, beat_t* keys, ap_uint<32>* done_ring, int njobs, int ring_size) {
+#pragma HLS INTERFACE m_axi port=jobs offset=slave bundle=gmem0 depth=512
+// done_ring shares the keys port: AXI keeps writes on one port in order, so
+// a completion entry can never land before the keypair it announces
+#pragma HLS INTERFACE m_axi port=keys offset=slave bundle=gmem1 depth=19456
+#pragma HLS INTERFACE m_axi port=done_ring offset=slave bundle=gmem1 depth=64
+#pragma HLS INTERFACE s_axilite port=jobs bundle=control
+#pragma HLS INTERFACE s_axilite port=keys bundle=control
+#pragma HLS INTERFACE s_axilite port=done_ring bundle=control
+#pragma HLS INTERFACE s_axilite port=njobs bundle=control
+#pragma HLS INTERFACE s_axilite port=ring_size bundle=control
+#pragma HLS INTERFACE s_axilite port=return bundle=control
+
+    // No ring to post to: nothing to do
+    if (ring_size <= 0)
+        return;
+
+    keygen_multi_dataflow(jobs, keys, done_ring, njobs, ring_size);
+}
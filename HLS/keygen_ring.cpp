@@ -0,0 +1,143 @@
+#include "unified.h"
+
+// Autonomous keypair pre-generation.
+//
+// DRBG: a 32-byte key K, ratcheted on every call (forward secrecy) and
+// mixed with fresh host seed material on reseed:
+//   reseed:   K <- SHAKE256(K || seed || 0x01)[0:32]
+//   generate: d || z || K <- SHAKE256(K || ctr (LE32) || 0x02)[0:96]
+// ctr counts generate calls since the last reseed; after
+// DRBG_RESEED_INTERVAL of them the core refuses to run until reseeded.
+
+// Mix seed into the DRBG key
+void drbg_reseed(byte_t key[MLKEM_SYMBYTES], const byte_t seed[MLKEM_SYMBYTES]) {
+#pragma HLS INLINE off
+    byte_t in[2 * MLKEM_SYMBYTES + 1];
+    byte_t out[MLKEM_SYMBYTES];
+#pragma HLS ARRAY_PARTITION variable=in complete
+#pragma HLS ARRAY_PARTITION variable=out complete
+
+    for (int i = 0; i < MLKEM_SYMBYTES; i++) {
+#pragma HLS UNROLL
+        in[i] = key[i];
+        in[MLKEM_SYMBYTES + i] = seed[i];
+    }
+    in[2 * MLKEM_SYMBYTES] = 0x01;
+
+    shake256(in, 2 * MLKEM_SYMBYTES + 1, out, MLKEM_SYMBYTES);
+
+    for (int i = 0; i < MLKEM_SYMBYTES; i++) {
+#pragma HLS UNROLL
+        key[i] = out[i];
+    }
+}
+
+// Draw (d, z) for one keypair and ratchet the key
+void drbg_generate(byte_t key[MLKEM_SYMBYTES], uint32_t ctr, byte_t d[MLKEM_SYMBYTES], byte_t z[MLKEM_SYMBYTES]) {
+#pragma HLS INLINE off
+    byte_t in[MLKEM_SYMBYTES + 5];
+    byte_t out[3 * MLKEM_SYMBYTES];
+#pragma HLS ARRAY_PARTITION variable=in complete
+#pragma HLS ARRAY_PARTITION variable=out complete
+
+    for (int i = 0; i < MLKEM_SYMBYTES; i++) {
+#pragma HLS UNROLL
+        in[i] = key[i];
+    }
+    for (int i = 0; i < 4; i++) {
+#pragma HLS UNROLL
+        in[MLKEM_SYMBYTES + i] = (byte_t)(ctr >> (8 * i));
+    }
+    in[MLKEM_SYMBYTES + 4] = 0x02;
+
+    shake256(in, MLKEM_SYMBYTES + 5, out, 3 * MLKEM_SYMBYTES);
+
+    for (int i = 0; i < MLKEM_SYMBYTES; i++) {
+#pragma HLS UNROLL
+        d[i] = out[i];
+        z[i] = out[MLKEM_SYMBYTES + i];
+        key[i] = out[2 * MLKEM_SYMBYTES + i];
+    }
+}
+
+int mlkem512_keygen_ring_top(const beat_t seed[MLKEM_SYMBEATS], int reseed, beat_t* ring,
+                             volatile uint32_t* ring_ctrl, int ring_slots, int nkeys) {
+#pragma HLS INTERFACE m_axi port=seed offset=slave bundle=gmem0 depth=4
+#pragma HLS INTERFACE m_axi port=ring offset=slave bundle=gmem1 depth=1216
+#pragma HLS INTERFACE m_axi port=ring_ctrl offset=slave bundle=gmem1 depth=4
+#pragma HLS INTERFACE s_axilite port=seed bundle=control
+#pragma HLS INTERFACE s_axilite port=reseed bundle=control
+#pragma HLS INTERFACE s_axilite port=ring bundle=control
+#pragma HLS INTERFACE s_axilite port=ring_ctrl bundle=control
+#pragma HLS INTERFACE s_axilite port=ring_slots bundle=control
+#pragma HLS INTERFACE s_axilite port=nkeys bundle=control
+#pragma HLS INTERFACE s_axilite port=return bundle=control
+
+    // DRBG state lives in the core across invocations
+    static byte_t drbg_key[MLKEM_SYMBYTES];
+    static uint32_t drbg_ctr = DRBG_RESEED_INTERVAL;   // Unseeded: must reseed first
+#pragma HLS ARRAY_PARTITION variable=drbg_key complete
+
+    // No ring to fill: leave the DRBG and ring_ctrl untouched
+    if (ring_slots <= 0)
+        return 0;
+
+    if (reseed) {
+        byte_t s[MLKEM_SYMBYTES];
+#pragma HLS ARRAY_PARTITION variable=s complete
+        beats_tobytes(s, seed, MLKEM_SYMBEATS);
+        drbg_reseed(drbg_key, s);
+        drbg_ctr = 0;
+    }
+
+    // Ring slots are written in place, so both pk and sk go out through the
+    // same m_axi port as the head update and land before it
+    uint32_t head = ring_ctrl[RING_HEAD];
+    int produced = 0;
+
+    while (nkeys == 0 || produced < nkeys) {
+#pragma HLS LOOP_TRIPCOUNT min=1 max=64
+        if (ring_ctrl[RING_STOP] != 0 || drbg_ctr >= DRBG_RESEED_INTERVAL)
+            break;
+
+        // Stall while the host has not consumed the oldest slot
+        bool stopped = false;
+        while ((uint32_t)(head - ring_ctrl[RING_TAIL]) >= (uint32_t)ring_slots) {
+#pragma HLS LOOP_TRIPCOUNT min=0 max=1
+            if (ring_ctrl[RING_STOP] != 0) {
+                stopped = true;
+                break;
+            }
+        }
+        if (stopped)
+            break;
+
+        byte_t d[MLKEM_SYMBYTES], z[MLKEM_SYMBYTES];
+        beat_t pk[MLKEM_PUBLICKEYBEATS], sk[MLKEM_SECRETKEYBEATS];
+        drbg_generate(drbg_key, drbg_ctr, d, z);
+        drbg_ctr++;
+
+        mlkem512_keygen(d, z, pk, sk);
+
+        int base = (int)(head % (uint32_t)ring_slots) * KEYGEN_KEY_BEATS;
+        for (int i = 0; i < MLKEM_PUBLICKEYBEATS; i++) {
+#pragma HLS PIPELINE II=1
+            ring[base + i] = pk[i];
+        }
+        for (int i = 0; i < MLKEM_SECRETKEYBEATS; i++) {
+#pragma HLS PIPELINE II=1
+            ring[base + MLKEM_PUBLICKEYBEATS + i] = sk[i];
+        }
+
+#ifndef __SYNTHESIS__
+        // The threaded C model (driver mock) needs the same ordering
+        __sync_synchronize();
+#endif
+        head++;
+        ring_ctrl[RING_HEAD] = head;
+        produced++;
+    }
+
+    ring_ctrl[RING_STATUS] = drbg_ctr >= DRBG_RESEED_INTERVAL ? (drbg_ctr | RING_STATUS_RESEED) : drbg_ctr;
+    return produced;
+}
@@ -1,5 +1,10 @@
 #include "unified.h"
 
+#ifndef __SYNTHESIS__
+thread_local uint64_t ct_trips[CT_STAGES];
+thread_local int ct_stage;
+#endif
+
 // Keccak-f[1600] implementation (from PRF module)
 
 
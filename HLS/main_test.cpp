@@ -3,11 +3,12 @@
 #include <random>
 #include <chrono>
 #include <cstring>
+#include <sstream>
 #include "unified.h"
 
 
 // Function prototypes
-void mlkem512_keygen_top(const byte_t seed[32],const byte_t z[32], byte_t pk[MLKEM_PUBLICKEYBYTES], byte_t sk[MLKEM_SECRETKEYBYTES]);
+void mlkem512_keygen_top(const byte_t seed[32],const byte_t z[32], beat_t pk[MLKEM_PUBLICKEYBEATS], beat_t sk[MLKEM_SECRETKEYBEATS]);
 
 void print_hex(const byte_t* data, int len, const std::string& label) {
     std::cout << label << ": ";
@@ -36,9 +37,12 @@ bool test_deterministic() {
     };
     byte_t pk1[MLKEM_PUBLICKEYBYTES], sk1[MLKEM_SECRETKEYBYTES];
     byte_t pk2[MLKEM_PUBLICKEYBYTES], sk2[MLKEM_SECRETKEYBYTES];
+    beat_t pk_beats[MLKEM_PUBLICKEYBEATS], sk_beats[MLKEM_SECRETKEYBEATS];
     
     // Generate first key pair
-    mlkem512_keygen_top(seed,z, pk1, sk1);
+    mlkem512_keygen_top(seed,z, pk_beats, sk_beats);
+    beats_tobytes(pk1, pk_beats, MLKEM_PUBLICKEYBEATS);
+    beats_tobytes(sk1, sk_beats, MLKEM_SECRETKEYBEATS);
     
     // Generate second key pair with same seed
     //mlkem512_keygen_top(seed, pk2, sk2);
@@ -51,7 +55,643 @@ bool test_deterministic() {
     return 1;
 }
 
+// Compression round trip: Decompress(Compress(x)) stays within round(q / 2^(d+1))
+// of x, and Compress(Decompress(y)) == y for every packed value
+bool test_compress() {
+    std::cout << "\n=== Testing Compression (du=10, dv=4) ===" << std::endl;
+
+    poly_t a, b;
+    polyvec_t av, bv;
+    byte_t cv[MLKEM_POLYCOMPRESSEDBYTES_DV], cv2[MLKEM_POLYCOMPRESSEDBYTES_DV];
+    byte_t cu[MLKEM_POLYVECCOMPRESSEDBYTES_DU], cu2[MLKEM_POLYVECCOMPRESSEDBYTES_DU];
+    bool ok = true;
+
+    for (int i = 0; i < MLKEM_N; i++) {
+        a.coeffs[i] = (i * 13 + 7) % MLKEM_Q;
+        av.vec[0].coeffs[i] = (i * 29 + 1) % MLKEM_Q;
+        av.vec[1].coeffs[i] = MLKEM_Q - 1 - i;
+    }
+
+    poly_compress(cv, &a);
+    poly_decompress(&b, cv);
+    poly_compress(cv2, &b);
+    for (int i = 0; i < MLKEM_N; i++) {
+        int d = ((int)a.coeffs[i] - (int)b.coeffs[i] + MLKEM_Q) % MLKEM_Q;
+        if (d > MLKEM_Q / 2) d = MLKEM_Q - d;
+        if (d > 104) ok = false;
+    }
+    for (int i = 0; i < MLKEM_POLYCOMPRESSEDBYTES_DV; i++) {
+        if (cv[i] != cv2[i]) ok = false;
+    }
+
+    polyvec_compress(cu, &av);
+    polyvec_decompress(&bv, cu);
+    polyvec_compress(cu2, &bv);
+    for (int k = 0; k < MLKEM_K; k++) {
+        for (int i = 0; i < MLKEM_N; i++) {
+            int d = ((int)av.vec[k].coeffs[i] - (int)bv.vec[k].coeffs[i] + MLKEM_Q) % MLKEM_Q;
+            if (d > MLKEM_Q / 2) d = MLKEM_Q - d;
+            if (d > 2) ok = false;
+        }
+    }
+    for (int i = 0; i < MLKEM_POLYVECCOMPRESSEDBYTES_DU; i++) {
+        if (cu[i] != cu2[i]) ok = false;
+    }
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
+// Digest of (i * 7 + 3) for i < len, as lowercase hex
+static std::string hash_hex(void (*hash)(const byte_t*, int, byte_t*), int len, int outlen) {
+    byte_t in[200], out[64];
+    for (int i = 0; i < len; i++)
+        in[i] = (byte_t)(i * 7 + 3);
+    hash(in, len, out);
+
+    std::ostringstream os;
+    for (int i = 0; i < outlen; i++)
+        os << std::hex << std::setw(2) << std::setfill('0') << (int)out[i];
+    return os.str();
+}
+
+static void shake128_32(const byte_t* in, int len, byte_t* out) { shake128(in, len, out, 32); }
+static void shake256_32(const byte_t* in, int len, byte_t* out) { shake256(in, len, out, 32); }
+
+// Sponges on inputs up to and across block boundaries (hashlib reference)
+bool test_sha3_multiblock() {
+    std::cout << "\n=== Testing SHA3/SHAKE multi-block absorb ===" << std::endl;
+
+    bool ok = true;
+    ok &= hash_hex(G, 71, 64) == "a02d5795bffd44cb0ac3cc3401ae89056b8017242eaf7e802033e974672ce794"
+                                 "5811760c3b0d9578bc51bf90c364636ac87cda9b4f3e45620ea9c030421e9d86";
+    ok &= hash_hex(G, 72, 64) == "2ec0da5ff440c192d33033c4257eb39dcbd27edd7e41b5ac8db9daf13db501a2"
+                                 "ef938151aaddd82f600335654f77512cbcc926ec5abb05b79282ec716d685618";
+    ok &= hash_hex(G, 200, 64) == "14fb36d333d34fccb38c8801d7692c9350a324cbc44448b63aca9d3cfdb12fb5"
+                                  "2a08934fefda157796735871f1541d1e5bcb70cb03ca13186c94c5c45e1f1cad";
+    ok &= hash_hex(H, 200, 32) == "9da37ea2fb33acd563a014f50d6f7cc225f25577a81d900452b72b5de98f239d";
+    ok &= hash_hex(shake128_32, 200, 32) == "243a1de243bd9dce318a217d75b1b026985c06b5de480fc6236143b663f7fe2c";
+    ok &= hash_hex(shake256_32, 200, 32) == "cd24482e6e8eca556bce1cad6dfec6f4b53bac32f6a0eb0a99aaaf25018db3c1";
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
+// Known answer from an independent Python reference (hashlib, round-3
+// keygen) for d[i] = 6 * 31 + 7i + 1, z[i] = 6 * 17 + 3i + 5: entry A[0][1]
+// needs 516 XOF bytes, so poly_uniform must squeeze a fourth SHAKE128 block
+bool test_kat_long_xof() {
+    std::cout << "\n=== Testing keygen KAT with a 4-block matrix entry ===" << std::endl;
+
+    byte_t d[32], z[32];
+    for (int i = 0; i < 32; i++) {
+        d[i] = (byte_t)(6 * 31 + i * 7 + 1);
+        z[i] = (byte_t)(6 * 17 + i * 3 + 5);
+    }
+    beat_t pk_beats[MLKEM_PUBLICKEYBEATS], sk_beats[MLKEM_SECRETKEYBEATS];
+    byte_t pk[MLKEM_PUBLICKEYBYTES], sk[MLKEM_SECRETKEYBYTES], digest[32];
+    mlkem512_keygen_top(d, z, pk_beats, sk_beats);
+    beats_tobytes(pk, pk_beats, MLKEM_PUBLICKEYBEATS);
+    beats_tobytes(sk, sk_beats, MLKEM_SECRETKEYBEATS);
+
+    auto hex = [&](const byte_t* msg, int len) {
+        H(msg, len, digest);
+        std::ostringstream os;
+        for (int i = 0; i < 32; i++)
+            os << std::hex << std::setw(2) << std::setfill('0') << (int)digest[i];
+        return os.str();
+    };
+    bool ok = hex(pk, MLKEM_PUBLICKEYBYTES) == "ab16b0f0d88c814b8abd1b50c881d54e2124449823dde9d9f5b93ea4a7dd28c6";
+    ok &= hex(sk, MLKEM_SECRETKEYBYTES) == "11ae035942683a8b9d70968428c3b5a216225e7c66423d0910f56acefb57d7ba";
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
+// ntt_forward against the textbook transform over the plain ntt_zetas
+// table, then ntt_inverse back to the input
+bool test_ntt() {
+    std::cout << "\n=== Testing NTT / inverse NTT ===" << std::endl;
+
+    poly_t p;
+    int ref[MLKEM_N], in[MLKEM_N];
+    for (int i = 0; i < MLKEM_N; i++) {
+        in[i] = ref[i] = (i * 1103 + 7) % MLKEM_Q;
+        p.coeffs[i] = in[i];
+    }
+
+    int k = 1;
+    for (int len = 128; len >= 2; len >>= 1) {
+        for (int start = 0; start < MLKEM_N; start += 2 * len) {
+            int zeta = ntt_zetas[k++];
+            for (int j = start; j < start + len; j++) {
+                int t = zeta * ref[j + len] % MLKEM_Q;
+                ref[j + len] = (ref[j] - t + MLKEM_Q) % MLKEM_Q;
+                ref[j] = (ref[j] + t) % MLKEM_Q;
+            }
+        }
+    }
+
+    bool ok = true;
+    ntt_forward(&p);
+    for (int i = 0; i < MLKEM_N; i++) {
+        if (p.coeffs[i] != ref[i]) ok = false;
+    }
+    ntt_inverse(&p);
+    for (int i = 0; i < MLKEM_N; i++) {
+        if (p.coeffs[i] != in[i]) ok = false;
+    }
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
+// Streaming NTT/INTT: three polynomials back to back must match the
+// iterative engine one by one, and the inverse must undo the forward
+bool test_ntt_stream() {
+    std::cout << "\n=== Testing streaming NTT (" << NTT_STREAM_LANES << " lanes) ===" << std::endl;
+
+    const int n = 3;
+    static poly_t in[n], fwd[n], back[n], ref[n];
+    bool ok = true;
+    for (int k = 0; k < n; k++) {
+        for (int i = 0; i < MLKEM_N; i++)
+            in[k].coeffs[i] = ref[k].coeffs[i] = (i * 1103 + k * 2087 + 7) % MLKEM_Q;
+        ntt_forward(&ref[k]);
+    }
+
+    ntt_forward_polys(fwd, in, n);
+    ntt_inverse_polys(back, fwd, n);
+
+    for (int k = 0; k < n; k++) {
+        for (int i = 0; i < MLKEM_N; i++) {
+            if (fwd[k].coeffs[i] != ref[k].coeffs[i]) ok = false;
+            if (back[k].coeffs[i] != in[k].coeffs[i]) ok = false;
+        }
+    }
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
+// Bound-tracking arithmetic: sums, differences and products of canonical
+// coefficients, and a lazy sum of two products, reduce to the true residue
+bool test_bounded_coeff() {
+    std::cout << "\n=== Testing bounded coefficients ===" << std::endl;
+
+    bool ok = true;
+    for (int x = 0; x < MLKEM_Q; x += 7) {
+        for (int y = 0; y < MLKEM_Q; y += 5) {
+            coeff_q_t a(x), b(y);
+            if (bounded_reduce(a + b).v != (x + y) % MLKEM_Q) ok = false;
+            if (bounded_reduce(a - b).v != (x - y + MLKEM_Q) % MLKEM_Q) ok = false;
+            if (bounded_reduce(a * b).v != x * y % MLKEM_Q) ok = false;
+            if (bounded_reduce(a * b + b * b).v != (x * y + y * y) % MLKEM_Q) ok = false;
+        }
+    }
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
+// Karatsuba basemul against schoolbook products mod (X^2 - zeta) in plain
+// integers, including all-(q-1) inputs for the widest lazy sums
+bool test_basemul() {
+    std::cout << "\n=== Testing Karatsuba basemul ===" << std::endl;
+
+    bool ok = true;
+    for (int pass = 0; pass < 2; pass++) {
+        poly_t a, b, r;
+        for (int i = 0; i < MLKEM_N; i++) {
+            a.coeffs[i] = pass ? MLKEM_Q - 1 : (i * 389 + 17) % MLKEM_Q;
+            b.coeffs[i] = pass ? MLKEM_Q - 1 : (i * 1021 + 5) % MLKEM_Q;
+        }
+        poly_basemul_montgomery(&r, &a, &b);
+
+        for (int q = 0; q < MLKEM_N / 4; q++) {
+            for (int h = 0; h < 2; h++) {
+                int c = 4 * q + 2 * h;
+                int64_t zeta = h ? MLKEM_Q - ntt_zetas[64 + q] : ntt_zetas[64 + q];
+                int64_t a0 = a.coeffs[c], a1 = a.coeffs[c + 1];
+                int64_t b0 = b.coeffs[c], b1 = b.coeffs[c + 1];
+                if (r.coeffs[c] != (a0 * b0 + a1 * b1 % MLKEM_Q * zeta) % MLKEM_Q) ok = false;
+                if (r.coeffs[c + 1] != (a0 * b1 + a1 * b0) % MLKEM_Q) ok = false;
+            }
+        }
+    }
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
+// Fused multiply-accumulate against per-product basemul + poly_add,
+// including all-(q-1) inputs for the widest lazy sums
+bool test_pointwise_acc() {
+    std::cout << "\n=== Testing fused basemul accumulate ===" << std::endl;
+
+    bool ok = true;
+    for (int pass = 0; pass < 2; pass++) {
+        polyvec_t a, b, bz;
+        poly_t r, ref, t;
+        for (int j = 0; j < MLKEM_K; j++) {
+            for (int i = 0; i < MLKEM_N; i++) {
+                a.vec[j].coeffs[i] = pass ? MLKEM_Q - 1 : (i * 97 + j * 131 + 11) % MLKEM_Q;
+                b.vec[j].coeffs[i] = pass ? MLKEM_Q - 1 : (i * 53 + j * 211 + 3) % MLKEM_Q;
+            }
+        }
+
+        polyvec_basemul_precompute(&bz, &b);
+        polyvec_pointwise_acc_montgomery(&r, &a, &b, &bz);
+        poly_basemul_montgomery(&ref, &a.vec[0], &b.vec[0]);
+        for (int j = 1; j < MLKEM_K; j++) {
+            poly_basemul_montgomery(&t, &a.vec[j], &b.vec[j]);
+            poly_add(&ref, &ref, &t);
+        }
+
+        for (int i = 0; i < MLKEM_N; i++) {
+            // Both sides are canonical: an off-by-q result must not match
+            if (r.coeffs[i] != ref.coeffs[i]) ok = false;
+        }
+    }
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
+// Transposed expansion samples A^T directly: entry (i, j) equals entry
+// (j, i) of the normal expansion, and the off-diagonal entries differ
+bool test_matrix_transpose() {
+    std::cout << "\n=== Testing Transposed Matrix Expansion ===" << std::endl;
+
+    static matrix_t A, At;
+    byte_t rho[32];
+    bool ok = true;
+    for (int i = 0; i < 32; i++)
+        rho[i] = (byte_t)(i * 29 + 7);
+
+    matrix_expand(&A, rho, false);
+    matrix_expand(&At, rho, true);
+
+    for (int i = 0; i < MLKEM_K; i++) {
+        for (int j = 0; j < MLKEM_K; j++) {
+            bool same = true;
+            for (int c = 0; c < MLKEM_N; c++) {
+                if (At.rows[i].vec[j].coeffs[c] != A.rows[j].vec[i].coeffs[c])
+                    ok = false;
+                if (At.rows[i].vec[j].coeffs[c] != A.rows[i].vec[j].coeffs[c])
+                    same = false;
+            }
+            if (i != j && same)
+                ok = false;
+        }
+    }
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
+// Multi-core top: every keypair must match the single-core top and the
+// completion ring must list all jobs
+bool test_multicore() {
+    std::cout << "\n=== Testing Multi-core Keygen (" << KEYGEN_CORES << " cores) ===" << std::endl;
+
+    const int njobs = 2 * KEYGEN_CORES + 1;
+    const int ring_size = 4;
+    static beat_t jobs[njobs * KEYGEN_JOB_BEATS];
+    static beat_t keys[njobs * KEYGEN_KEY_BEATS];
+    ap_uint<32> ring[ring_size];
+    bool ok = true;
+
+    for (int i = 0; i < njobs * KEYGEN_JOB_BEATS; i++) {
+        jobs[i] = ((beat_t)(i * 0x9E3779B9u) << 32) | (beat_t)(i * 0x85EBCA6Bu + 1);
+    }
+    for (int i = 0; i < ring_size; i++) {
+        ring[i] = 0;
+    }
+
+    mlkem512_keygen_multi_top(jobs, keys, ring, njobs, ring_size);
+
+    for (int n = 0; n < njobs; n++) {
+        byte_t d[32], z[32];
+        beat_t pk[MLKEM_PUBLICKEYBEATS], sk[MLKEM_SECRETKEYBEATS];
+        beats_tobytes(d, jobs + n * KEYGEN_JOB_BEATS, MLKEM_SYMBEATS);
+        beats_tobytes(z, jobs + n * KEYGEN_JOB_BEATS + MLKEM_SYMBEATS, MLKEM_SYMBEATS);
+        mlkem512_keygen_top(d, z, pk, sk);
+
+        for (int i = 0; i < MLKEM_PUBLICKEYBEATS; i++) {
+            if (keys[n * KEYGEN_KEY_BEATS + i] != pk[i]) ok = false;
+        }
+        for (int i = 0; i < MLKEM_SECRETKEYBEATS; i++) {
+            if (keys[n * KEYGEN_KEY_BEATS + MLKEM_PUBLICKEYBEATS + i] != sk[i]) ok = false;
+        }
+    }
+    // Last ring_size completions, in ring order
+    for (int n = (njobs > ring_size ? njobs - ring_size : 0); n < njobs; n++) {
+        if (ring[n % ring_size] != (unsigned)(n + 1)) ok = false;
+    }
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
 // Main function
+// Keypair ring: unseeded refusal, DRBG output against SHAKE256 computed
+// here, wrap-around and the stop flag
+bool test_keygen_ring() {
+    std::cout << "\n=== Testing Keypair Ring (on-chip DRBG) ===" << std::endl;
+
+    const int slots = 4;
+    static beat_t ring[slots * KEYGEN_KEY_BEATS];
+    volatile uint32_t ctrl[RING_CTRL_WORDS] = {0, 0, 0, 0};
+    beat_t seed[MLKEM_SYMBEATS];
+    byte_t seed_bytes[MLKEM_SYMBYTES];
+    bool ok = true;
+
+    for (int i = 0; i < MLKEM_SYMBEATS; i++)
+        seed[i] = (beat_t)0x0123456789abcdefULL * (i + 1);
+    beats_tobytes(seed_bytes, seed, MLKEM_SYMBEATS);
+
+    // Never seeded: nothing produced, reseed requested
+    ok &= mlkem512_keygen_ring_top(seed, 0, ring, ctrl, slots, 1) == 0;
+    ok &= (ctrl[RING_STATUS] & RING_STATUS_RESEED) != 0 && ctrl[RING_HEAD] == 0;
+
+    // Reference DRBG: K = SHAKE256(0^32 || seed || 1), then per key
+    // d || z || K = SHAKE256(K || ctr || 2)
+    byte_t key[MLKEM_SYMBYTES], in[2 * MLKEM_SYMBYTES + 1], out[3 * MLKEM_SYMBYTES];
+    for (int i = 0; i < MLKEM_SYMBYTES; i++) {
+        in[i] = 0;
+        in[MLKEM_SYMBYTES + i] = seed_bytes[i];
+    }
+    in[2 * MLKEM_SYMBYTES] = 0x01;
+    shake256(in, 2 * MLKEM_SYMBYTES + 1, key, MLKEM_SYMBYTES);
+
+    ok &= mlkem512_keygen_ring_top(seed, 1, ring, ctrl, slots, 3) == 3;
+    ok &= ctrl[RING_HEAD] == 3 && ctrl[RING_STATUS] == 3;
+
+    // Stop flag: returns at once
+    ctrl[RING_STOP] = 1;
+    ok &= mlkem512_keygen_ring_top(seed, 0, ring, ctrl, slots, 0) == 0;
+    ctrl[RING_STOP] = 0;
+
+    // Host consumed three: two more wrap around into slots 3 and 0
+    ctrl[RING_TAIL] = 3;
+    ok &= mlkem512_keygen_ring_top(seed, 0, ring, ctrl, slots, 2) == 2;
+    ok &= ctrl[RING_HEAD] == 5;
+
+    for (uint32_t n = 0; n < 5; n++) {
+        byte_t d[MLKEM_SYMBYTES], z[MLKEM_SYMBYTES];
+        beat_t pk[MLKEM_PUBLICKEYBEATS], sk[MLKEM_SECRETKEYBEATS];
+        for (int i = 0; i < MLKEM_SYMBYTES; i++)
+            in[i] = key[i];
+        for (int i = 0; i < 4; i++)
+            in[MLKEM_SYMBYTES + i] = (byte_t)(n >> (8 * i));
+        in[MLKEM_SYMBYTES + 4] = 0x02;
+        shake256(in, MLKEM_SYMBYTES + 5, out, 3 * MLKEM_SYMBYTES);
+        for (int i = 0; i < MLKEM_SYMBYTES; i++) {
+            d[i] = out[i];
+            z[i] = out[MLKEM_SYMBYTES + i];
+            key[i] = out[2 * MLKEM_SYMBYTES + i];
+        }
+
+        // Slot 0 was overwritten by key 4
+        if (n == 0)
+            continue;
+        mlkem512_keygen_top(d, z, pk, sk);
+        const beat_t* slot = ring + (n % slots) * KEYGEN_KEY_BEATS;
+        for (int i = 0; i < MLKEM_PUBLICKEYBEATS; i++) {
+            if (slot[i] != pk[i]) ok = false;
+        }
+        for (int i = 0; i < MLKEM_SECRETKEYBEATS; i++) {
+            if (slot[MLKEM_PUBLICKEYBEATS + i] != sk[i]) ok = false;
+        }
+    }
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
+// Seed-form sk: expansion must rebuild the exact sk keygen writes, and the
+// ciphertext unpacked alongside must decompress every u and v coefficient
+bool test_sk_expand() {
+    std::cout << "\n=== Testing seed-form sk expansion ===" << std::endl;
+
+    byte_t d[MLKEM_SYMBYTES], z[MLKEM_SYMBYTES], ct_bytes[MLKEM_CIPHERTEXTBYTES];
+    beat_t pk[MLKEM_PUBLICKEYBEATS], sk_ref[MLKEM_SECRETKEYBEATS], sk[MLKEM_SECRETKEYBEATS];
+    beat_t sk_seed[MLKEM_SEEDSKBEATS], ct[MLKEM_CIPHERTEXTBEATS], ct_polys[MLKEM_CTPOLYBEATS];
+    bool ok = true;
+
+    for (int i = 0; i < MLKEM_SYMBYTES; i++) {
+        d[i] = (byte_t)(i * 13 + 1);
+        z[i] = (byte_t)(i * 71 + 9);
+    }
+    for (int i = 0; i < MLKEM_CIPHERTEXTBYTES; i++)
+        ct_bytes[i] = (byte_t)(i * 151 + 77);
+    bytes_tobeats(sk_seed, d, MLKEM_SYMBEATS);
+    bytes_tobeats(sk_seed + MLKEM_SYMBEATS, z, MLKEM_SYMBEATS);
+    bytes_tobeats(ct, ct_bytes, MLKEM_CIPHERTEXTBEATS);
+
+    mlkem512_keygen_top(d, z, pk, sk_ref);
+    mlkem512_sk_expand_top(sk_seed, ct, sk, ct_polys);
+
+    for (int i = 0; i < MLKEM_SECRETKEYBEATS; i++) {
+        if (sk[i] != sk_ref[i]) ok = false;
+    }
+
+    // u: 10-bit fields, round(x * q / 1024); v: 4-bit fields, round(x * q / 16)
+    for (int k = 0; k <= MLKEM_K; k++) {
+        poly_t p;
+        poly_frombeats(&p, ct_polys + k * MLKEM_POLYBEATS);
+        for (int i = 0; i < MLKEM_N; i++) {
+            int x, want;
+            if (k < MLKEM_K) {
+                int bit = 10 * (k * MLKEM_N + i);
+                x = (((int)ct_bytes[bit / 8] | ((int)ct_bytes[bit / 8 + 1] << 8)) >> (bit % 8)) & 0x3ff;
+                want = (x * MLKEM_Q + 512) >> 10;
+            } else {
+                x = ((int)ct_bytes[MLKEM_POLYVECCOMPRESSEDBYTES_DU + i / 2] >> (4 * (i % 2))) & 0xf;
+                want = (x * MLKEM_Q + 8) >> 4;
+            }
+            if (p.coeffs[i] != want) ok = false;
+        }
+    }
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
+// Batched pk check: 40 copies of a real pk (two bitmap words), some with a
+// t_hat field forced to q, 4095 or q - 1 at group and key boundaries, and
+// one with garbage in rho, which is not checked
+bool test_pk_check() {
+    std::cout << "\n=== Testing batched pk validation ===" << std::endl;
+
+    const int n = 40;
+    static beat_t pks[n * MLKEM_PUBLICKEYBEATS];
+    byte_t d[MLKEM_SYMBYTES], z[MLKEM_SYMBYTES];
+    beat_t pk[MLKEM_PUBLICKEYBEATS], sk[MLKEM_SECRETKEYBEATS];
+    ap_uint<32> valid[2] = {0, 0};
+    bool ok = true;
+
+    for (int i = 0; i < MLKEM_SYMBYTES; i++) {
+        d[i] = (byte_t)(i * 5 + 3);
+        z[i] = (byte_t)i;
+    }
+    mlkem512_keygen_top(d, z, pk, sk);
+    for (int k = 0; k < n; k++) {
+        for (int i = 0; i < MLKEM_PUBLICKEYBEATS; i++)
+            pks[k * MLKEM_PUBLICKEYBEATS + i] = pk[i];
+    }
+
+    // Set 12-bit coefficient c of key k
+    auto set_coeff = [&](int k, int c, int value) {
+        beat_t* p = pks + k * MLKEM_PUBLICKEYBEATS;
+        for (int b = 0; b < 12; b++) {
+            int bit = 12 * c + b;
+            beat_t mask = (beat_t)1 << (bit % 64);
+            p[bit / 64] = ((value >> b) & 1) ? (beat_t)(p[bit / 64] | mask) : (beat_t)(p[bit / 64] & ~mask);
+        }
+    };
+    set_coeff(1, 0, MLKEM_Q);                       // First coefficient
+    set_coeff(5, 5, 4095);                          // Spans beats 0 and 1
+    set_coeff(6, 5, MLKEM_Q - 1);                   // Largest valid value
+    set_coeff(31, 2 * MLKEM_N - 1, MLKEM_Q);        // Last coefficient, last bit of word 0
+    set_coeff(32, 16 * 17 + 10, MLKEM_Q + 7);       // Spans beats 52 and 53
+    pks[33 * MLKEM_PUBLICKEYBEATS + MLKEM_PUBLICKEYBEATS - 1] = ~(beat_t)0;   // rho only
+    set_coeff(n - 1, 300, 3500);
+
+    uint32_t expect[2] = {0xffffffff, 0xff};
+    for (int k : {1, 5, 31, 32, n - 1})
+        expect[k / 32] &= ~(1u << (k % 32));
+
+    ok &= mlkem512_pk_check_top(pks, n, valid) == 5;
+    ok &= valid[0] == expect[0] && valid[1] == expect[1];
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
+// Batched Keccak top: a mix of modes and lengths (empty, rate-1, exactly
+// one rate, multi-block, long SHAKE output) against the single-shot
+// functions, more descriptors than states, and one unknown mode
+bool test_keccak_batch() {
+    std::cout << "\n=== Testing Batched Keccak Top ===" << std::endl;
+
+    struct { int mode, in_len, out_len; } req[] = {
+        {KECCAK_MODE_SHA3_256, 0, 32},    {KECCAK_MODE_SHA3_256, 135, 32},
+        {KECCAK_MODE_SHA3_512, 72, 64},   {KECCAK_MODE_SHA3_512, 200, 64},
+        {KECCAK_MODE_SHAKE128, 33, 504},  {KECCAK_MODE_SHAKE128, 168, 21},
+        {9, 10, 32},                      {KECCAK_MODE_SHAKE256, 65, 128},
+        {KECCAK_MODE_SHAKE256, 300, 300}, {KECCAK_MODE_SHA3_256, 1, 40},
+    };
+    const int n = sizeof(req) / sizeof(req[0]);
+    static beat_t desc[n * KECCAK_DESC_BEATS], in[512], out[512];
+    static byte_t in_bytes[4096], expect[512];
+    int in_off[n], out_off[n];
+    bool ok = true;
+
+    int in_pos = 0, out_pos = 0;
+    for (int k = 0; k < n; k++) {
+        in_off[k] = in_pos;
+        out_off[k] = out_pos;
+        for (int i = 0; i < req[k].in_len; i++)
+            in_bytes[in_pos + i] = (byte_t)(k * 37 + i * 11 + 3);
+        desc[k * KECCAK_DESC_BEATS] = (beat_t)in_pos | ((beat_t)req[k].in_len << 32);
+        desc[k * KECCAK_DESC_BEATS + 1] = (beat_t)out_pos | ((beat_t)req[k].out_len << 32) |
+                                          ((beat_t)req[k].mode << 56);
+        in_pos += (req[k].in_len + 7) & ~7;
+        out_pos += (req[k].out_len + 7) & ~7;
+    }
+    for (int i = 0; i < in_pos / 8; i++) {
+        in[i] = 0;
+        for (int j = 0; j < 8; j++)
+            in[i] |= (beat_t)in_bytes[8 * i + j] << (8 * j);
+    }
+    for (int i = 0; i < out_pos / 8; i++)
+        out[i] = ~(beat_t)0;
+
+    ok &= keccak_batch_top(desc, n, in, out) == 1;
+
+    for (int k = 0; k < n; k++) {
+        const byte_t* msg = in_bytes + in_off[k];
+        int len = req[k].out_len;
+        switch (req[k].mode) {
+        case KECCAK_MODE_SHA3_256: sha3_256(msg, req[k].in_len, expect); len = len < 32 ? len : 32; break;
+        case KECCAK_MODE_SHA3_512: sha3_512(msg, req[k].in_len, expect); break;
+        case KECCAK_MODE_SHAKE128: shake128(msg, req[k].in_len, expect, len); break;
+        case KECCAK_MODE_SHAKE256: shake256(msg, req[k].in_len, expect, len); break;
+        default: len = 0; break;
+        }
+
+        // Output bytes, zero to the end of their last beat, then untouched
+        int written = (len + 7) & ~7;
+        for (int i = 0; i < ((req[k].out_len + 7) & ~7); i++) {
+            int pos = out_off[k] + i;
+            byte_t got = (byte_t)(out[pos / 8] >> (8 * (pos % 8)));
+            byte_t want = i < len ? expect[i] : (byte_t)(i < written ? 0 : 0xff);
+            if (got != want) {
+                std::cout << "Descriptor " << k << " byte " << i << " mismatch" << std::endl;
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
+#ifndef CT_SEEDS
+#define CT_SEEDS 1000
+#endif
+
+// Run keygen on CT_SEEDS random (d, z) and require identical trip counts in
+// every stage that touches secrets; with MLKEM_FIXED_LATENCY=1 matrix
+// expansion must be fixed as well. Cycle-accurate counterpart: ct_check.sh.
+bool test_fixed_latency() {
+    static const char* names[CT_STAGES] = {"G", "matrix", "PRF", "CBD", "NTT", "basemul", "pack+H"};
+    std::cout << "\n=== Testing fixed latency (" << CT_SEEDS << " seeds, MLKEM_FIXED_LATENCY="
+              << MLKEM_FIXED_LATENCY << ") ===" << std::endl;
+
+    std::mt19937 rng(12345);
+    uint64_t ref[CT_STAGES], lo[CT_STAGES], hi[CT_STAGES];
+    bool ok = true;
+
+    for (int n = 0; n < CT_SEEDS; n++) {
+        byte_t d[32], z[32];
+        beat_t pk[MLKEM_PUBLICKEYBEATS], sk[MLKEM_SECRETKEYBEATS];
+        for (int i = 0; i < 32; i++) {
+            d[i] = rng() & 0xff;
+            z[i] = rng() & 0xff;
+        }
+
+        memset(ct_trips, 0, sizeof(ct_trips));
+        mlkem512_keygen_top(d, z, pk, sk);
+
+        for (int s = 0; s < CT_STAGES; s++) {
+            if (n == 0) {
+                ref[s] = lo[s] = hi[s] = ct_trips[s];
+            } else {
+                lo[s] = std::min(lo[s], ct_trips[s]);
+                hi[s] = std::max(hi[s], ct_trips[s]);
+            }
+        }
+    }
+
+    for (int s = 0; s < CT_STAGES; s++) {
+        bool fixed = lo[s] == hi[s];
+        bool required = s != CT_MATRIX || MLKEM_FIXED_LATENCY;
+        std::cout << std::setfill(' ') << std::setw(10) << names[s] << ": " << lo[s];
+        if (!fixed)
+            std::cout << " .. " << hi[s];
+        std::cout << (fixed ? "" : (required ? "  VARIES" : "  (public, varies)")) << std::endl;
+        if (required && (!fixed || ref[s] != lo[s]))
+            ok = false;
+    }
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
 int main(int argc, char* argv[]) {
     std::cout << "ML-KEM 512 Key Generation Test Suite" << std::endl;
     std::cout << "=====================================" << std::endl;
@@ -62,7 +702,22 @@ int main(int argc, char* argv[]) {
     //all_tests_passed &= test_key_sizes();
     //all_tests_passed &= test_known_vectors();
     all_tests_passed &= test_deterministic();
+    all_tests_passed &= test_compress();
+    all_tests_passed &= test_sha3_multiblock();
+    all_tests_passed &= test_kat_long_xof();
+    all_tests_passed &= test_ntt();
+    all_tests_passed &= test_ntt_stream();
+    all_tests_passed &= test_bounded_coeff();
+    all_tests_passed &= test_basemul();
+    all_tests_passed &= test_pointwise_acc();
+    all_tests_passed &= test_matrix_transpose();
+    all_tests_passed &= test_multicore();
+    all_tests_passed &= test_keygen_ring();
+    all_tests_passed &= test_sk_expand();
+    all_tests_passed &= test_pk_check();
+    all_tests_passed &= test_keccak_batch();
+    all_tests_passed &= test_fixed_latency();
     //all_tests_passed &= test_random_vectors(100);
     
-    return 0;
+    return all_tests_passed ? 0 : 1;
 }
\ No newline at end of file
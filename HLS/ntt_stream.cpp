@@ -0,0 +1,221 @@
+#include "unified.h"
+
+// Streaming NTT / inverse NTT.
+//
+// One dataflow process per layer, each with its own butterflies, so all 7
+// layers work on different data at once and a new polynomial can enter as
+// soon as the previous one has. Data arrive NTT_STREAM_LANES (P) consecutive
+// coefficients per cycle in natural order. A layer of length L pairs
+// coefficient j with j + L:
+//
+//   L >= P: the partners are L / P vectors apart. Each lane has a delay line
+//           of D = L / P entries acting as the commutator: the first half of
+//           every 2L block is parked in it, the second half meets it in the
+//           butterflies, the top outputs leave at once and the bottom
+//           outputs go back into the delay line and leave while the first
+//           half of the next block is parked. Latency D, throughput P.
+//   L <  P: the partners sit in the same vector; butterflies only.
+//
+// Every butterfly keeps coefficients in [0, q), the same arithmetic as
+// ntt_forward / ntt_inverse, so both engines give identical results.
+
+const int NTT_STREAM_VECS = MLKEM_N / NTT_STREAM_LANES;   // Vectors per polynomial
+
+// Cooley-Tukey (forward) or Gentleman-Sande (inverse) butterfly on (x, y)
+template <bool INV>
+static void ntt_stream_butterfly(coeff_t& x, coeff_t& y, coeff_t zeta) {
+#pragma HLS INLINE
+    coeff_q_t a(x);
+    if (!INV) {
+        coeff_q_t t(montgomery_reduce24((coeff_prod_t)zeta * y));
+        x = bounded_reduce(a + t).v;
+        y = bounded_reduce(a - t).v;
+    } else {
+        coeff_q_t c(y);
+        coeff_t d = bounded_reduce(c - a).v;
+        x = bounded_reduce(a + c).v;
+        y = montgomery_reduce24((coeff_prod_t)zeta * d);
+    }
+}
+
+// Twiddle of butterfly block k of the layer of length L: zeta_{128/L + k}
+// going forward, zeta_{256/L - 1 - k} going back (see make_ntt_*_rom)
+template <int L, bool INV>
+static coeff_t ntt_stream_zeta(int k) {
+#pragma HLS INLINE
+    return ntt_zetas_mont[INV ? 256 / L - 1 - k : 128 / L + k];
+}
+
+// Layer with partners in different vectors: delay-line commutator
+template <int L, bool INV>
+static void ntt_stream_layer(hls::stream<coeff_vec_t>& in, hls::stream<coeff_vec_t>& out, int npolys,
+                             std::true_type) {
+#pragma HLS INLINE off
+    const int D = L / NTT_STREAM_LANES;
+    coeff_t delay[NTT_STREAM_LANES][D];
+#pragma HLS ARRAY_PARTITION variable=delay complete dim=1
+
+    int total = npolys * NTT_STREAM_VECS;
+    int flush = npolys > 0 ? D : 0;
+    for (int t = 0; t < total + flush; t++) {
+#pragma HLS LOOP_TRIPCOUNT min=64 max=256
+#pragma HLS PIPELINE II=1
+        CT_TRIP();
+        coeff_vec_t x, y;
+        if (t < total)
+            x = in.read();
+
+        int p = t % (2 * D);
+        if (p < D) {
+            // First half: park x, release the bottom half of the previous block
+            for (int u = 0; u < NTT_STREAM_LANES; u++) {
+#pragma HLS UNROLL
+                y.c[u] = delay[u][p];
+                delay[u][p] = x.c[u];
+            }
+        } else {
+            coeff_t zeta = ntt_stream_zeta<L, INV>((t % NTT_STREAM_VECS) / (2 * D));
+            for (int u = 0; u < NTT_STREAM_LANES; u++) {
+#pragma HLS UNROLL
+                coeff_t top = delay[u][p - D];
+                coeff_t bot = x.c[u];
+                ntt_stream_butterfly<INV>(top, bot, zeta);
+                y.c[u] = top;
+                delay[u][p - D] = bot;
+            }
+        }
+
+        if (t >= D)
+            out.write(y);
+    }
+}
+
+// Layer with partners in the same vector
+template <int L, bool INV>
+static void ntt_stream_layer(hls::stream<coeff_vec_t>& in, hls::stream<coeff_vec_t>& out, int npolys,
+                             std::false_type) {
+#pragma HLS INLINE off
+    const int BLOCKS = NTT_STREAM_LANES / (2 * L);
+
+    for (int t = 0; t < npolys * NTT_STREAM_VECS; t++) {
+#pragma HLS LOOP_TRIPCOUNT min=64 max=256
+#pragma HLS PIPELINE II=1
+        CT_TRIP();
+        coeff_vec_t x = in.read();
+        for (int g = 0; g < BLOCKS; g++) {
+#pragma HLS UNROLL
+            coeff_t zeta = ntt_stream_zeta<L, INV>((t % NTT_STREAM_VECS) * BLOCKS + g);
+            for (int i = 0; i < L; i++) {
+#pragma HLS UNROLL
+                ntt_stream_butterfly<INV>(x.c[2 * L * g + i], x.c[2 * L * g + i + L], zeta);
+            }
+        }
+        out.write(x);
+    }
+}
+
+template <int L, bool INV>
+static void ntt_stream_layer(hls::stream<coeff_vec_t>& in, hls::stream<coeff_vec_t>& out, int npolys) {
+#pragma HLS INLINE
+    ntt_stream_layer<L, INV>(in, out, npolys, std::integral_constant<bool, (L >= NTT_STREAM_LANES)>());
+}
+
+// Final 128^-1 scaling of the inverse transform
+static void ntt_stream_scale(hls::stream<coeff_vec_t>& in, hls::stream<coeff_vec_t>& out, int npolys) {
+#pragma HLS INLINE off
+    for (int t = 0; t < npolys * NTT_STREAM_VECS; t++) {
+#pragma HLS LOOP_TRIPCOUNT min=64 max=256
+#pragma HLS PIPELINE II=1
+        coeff_vec_t x = in.read();
+        for (int u = 0; u < NTT_STREAM_LANES; u++) {
+#pragma HLS UNROLL
+            x.c[u] = montgomery_reduce24((coeff_prod_t)NTT_INV_SCALE_MONT * x.c[u]);
+        }
+        out.write(x);
+    }
+}
+
+void ntt_stream_forward(hls::stream<coeff_vec_t>& in, hls::stream<coeff_vec_t>& out, int npolys) {
+#pragma HLS DATAFLOW
+    hls::stream<coeff_vec_t> link[NTT_LAYERS - 1];
+#pragma HLS STREAM variable=link depth=2
+
+    ntt_stream_layer<128, false>(in, link[0], npolys);
+    ntt_stream_layer<64, false>(link[0], link[1], npolys);
+    ntt_stream_layer<32, false>(link[1], link[2], npolys);
+    ntt_stream_layer<16, false>(link[2], link[3], npolys);
+    ntt_stream_layer<8, false>(link[3], link[4], npolys);
+    ntt_stream_layer<4, false>(link[4], link[5], npolys);
+    ntt_stream_layer<2, false>(link[5], out, npolys);
+}
+
+void ntt_stream_inverse(hls::stream<coeff_vec_t>& in, hls::stream<coeff_vec_t>& out, int npolys) {
+#pragma HLS DATAFLOW
+    hls::stream<coeff_vec_t> link[NTT_LAYERS];
+#pragma HLS STREAM variable=link depth=2
+
+    ntt_stream_layer<2, true>(in, link[0], npolys);
+    ntt_stream_layer<4, true>(link[0], link[1], npolys);
+    ntt_stream_layer<8, true>(link[1], link[2], npolys);
+    ntt_stream_layer<16, true>(link[2], link[3], npolys);
+    ntt_stream_layer<32, true>(link[3], link[4], npolys);
+    ntt_stream_layer<64, true>(link[4], link[5], npolys);
+    ntt_stream_layer<128, true>(link[5], link[6], npolys);
+    ntt_stream_scale(link[6], out, npolys);
+}
+
+// Polynomials in and out of the stream, one vector per cycle
+static void ntt_stream_feed(const poly_t* a, int npolys, hls::stream<coeff_vec_t>& s) {
+#pragma HLS INLINE off
+    for (int n = 0; n < npolys; n++) {
+#pragma HLS LOOP_TRIPCOUNT min=2 max=4
+        for (int v = 0; v < NTT_STREAM_VECS; v++) {
+#pragma HLS PIPELINE II=1
+            coeff_vec_t x;
+            for (int u = 0; u < NTT_STREAM_LANES; u++) {
+#pragma HLS UNROLL
+                x.c[u] = a[n].coeffs[v * NTT_STREAM_LANES + u];
+            }
+            s.write(x);
+        }
+    }
+}
+
+static void ntt_stream_drain(hls::stream<coeff_vec_t>& s, int npolys, poly_t* r) {
+#pragma HLS INLINE off
+    for (int n = 0; n < npolys; n++) {
+#pragma HLS LOOP_TRIPCOUNT min=2 max=4
+        for (int v = 0; v < NTT_STREAM_VECS; v++) {
+#pragma HLS PIPELINE II=1
+            coeff_vec_t x = s.read();
+            for (int u = 0; u < NTT_STREAM_LANES; u++) {
+#pragma HLS UNROLL
+                r[n].coeffs[v * NTT_STREAM_LANES + u] = x.c[u];
+            }
+        }
+    }
+}
+
+void ntt_forward_polys(poly_t* r, const poly_t* a, int npolys) {
+#pragma HLS INLINE off
+#pragma HLS DATAFLOW
+    hls::stream<coeff_vec_t> in_s, out_s;
+#pragma HLS STREAM variable=in_s depth=2
+#pragma HLS STREAM variable=out_s depth=2
+
+    ntt_stream_feed(a, npolys, in_s);
+    ntt_stream_forward(in_s, out_s, npolys);
+    ntt_stream_drain(out_s, npolys, r);
+}
+
+void ntt_inverse_polys(poly_t* r, const poly_t* a, int npolys) {
+#pragma HLS INLINE off
+#pragma HLS DATAFLOW
+    hls::stream<coeff_vec_t> in_s, out_s;
+#pragma HLS STREAM variable=in_s depth=2
+#pragma HLS STREAM variable=out_s depth=2
+
+    ntt_stream_feed(a, npolys, in_s);
+    ntt_stream_inverse(in_s, out_s, npolys);
+    ntt_stream_drain(out_s, npolys, r);
+}
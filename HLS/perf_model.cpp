@@ -0,0 +1,738 @@
+// Cycle-approximate performance model of mlkem512_keygen.
+//
+// Plain C++ (no Vitis headers), so capacity questions can be answered in
+// seconds on any machine: how a change to keccak_f1600 or ntt_forward moves
+// end-to-end latency, and what throughput and queueing a batch of jobs sees
+// on mlkem512_keygen_top or mlkem512_keygen_multi_top.
+//
+// Stages mirror keygen.cpp, and their loops mirror the pragmas:
+//
+//   G        sha3_512: absorb 9 lanes, keccak_f1600, squeeze 64 bytes
+//   matrix   K*K poly_uniform: shake128 absorb, then per 168-byte block a
+//            squeeze and rejection sampling at II=1, as many blocks as the
+//            entry needs (5 with MLKEM_FIXED_LATENCY)
+//   PRF_s/e  prf_eta (2K + 1 calls, one is unused): shake256 of 33 bytes to 192
+//   CBD_s/e  polyvec_cbd_eta1: K loops of 64 at II=1
+//   NTT_s/e  polyvec_ntt: 7 layers of NTT_LANE_ITERS at II=2 per polynomial,
+//            or one streaming pass of K * 256 / P vectors
+//   basemul  matrix_vector_mul: precompute and K pointwise rows of
+//            BASEMUL_LANE_ITERS at II=1
+//   add      polyvec_add: K loops of 256 / POLY_BANKS at II=1
+//   pack+H   pk/sk beats, H(pk) absorbed on the way out (PK_HASH_BLOCKS
+//            blocks of 17 lanes), final permutation
+//
+// A pipelined loop of n trips takes (n - 1) * II + depth cycles. The
+// constants that turn that into reported latencies (pipeline wrapper
+// overhead, fill, per-call glue, Keccak/NTT/CBD iteration depths) are fitted
+// to the rows of a Vitis compile report, reports/hls_compile.rpt by default,
+// and the fit is printed against every row it can reproduce. Loop bodies
+// that have since changed (basemul, reduce, packing) take their depth from
+// the pragmas instead. The stage trip counts match the counters that
+// test_fixed_latency prints in csim.
+//
+// The body of mlkem512_keygen is not a dataflow region, so stages run in
+// program order. --dataflow starts each stage as soon as the stages it
+// reads from are done (G -> matrix, G -> PRF_s -> CBD_s -> NTT_s, ...) and
+// shows what overlapping them would buy; the critical path is printed
+// either way.
+//
+// Batch simulation: jobs arrive all at once (one job list) or as a Poisson
+// stream of --rate keys/s. --cores 0 is mlkem512_keygen_top, one job at a
+// time with --ctrl-cycles of host handshake per job; N > 0 is
+// mlkem512_keygen_multi_top with KEYGEN_CORES=N: round-robin dispatch into
+// 16-beat job FIFOs, N cores, and an in-order collector draining 304 beats
+// per keypair. Matrix expansion time varies per job with its rejection
+// sampling, drawn at random.
+//
+// Build: g++ -std=c++14 -O2 -o perf_model perf_model.cpp
+// Usage: ./perf_model [--keccak-ii N] [--banks 4|8|16] [--ntt-stream P]
+//                     [--fixed-latency] [--dataflow] [--cores 0,1,2,4]
+//                     [--jobs N] [--rate keys/s] [--ctrl-cycles N]
+//                     [--clock MHz] [--rpt file] [--seed N]
+// Defaults follow unified.h and hls_config.cfg (read from the current
+// directory when present).
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Fixed ML-KEM-512 sizes, as in unified.h
+const int K = 2;
+const int N = 256;
+const int Q = 3329;
+const int NTT_LAYERS = 7;
+const int SHAKE128_RATE_LANES = 21;
+const int SHAKE256_RATE_LANES = 17;
+const int SHA3_512_RATE_LANES = 9;
+const int SHA3_256_RATE_LANES = 17;
+const int REJ_BLOCK_TRIPS = SHAKE128_RATE_LANES * 8 / 3;   // Rejection trips per SHAKE128 block
+const int REJ_UNIFORM_FIXED_BLOCKS = 5;
+const int PRF_BYTES = 64 * 3;                   // 64 * MLKEM_ETA1
+const int POLY_TOBEATS_ITERS = N / 16;
+const int SYMBEATS = 4;
+const int PUBLICKEYBEATS = 100;
+const int PK_HASH_BLOCKS = PUBLICKEYBEATS / SHA3_256_RATE_LANES + 1;
+const int KEYGEN_JOB_BEATS = 2 * SYMBEATS;
+const int KEYGEN_KEY_BEATS = 304;
+const int JOB_FIFO_BEATS = 16;                  // job_s depth in keygen_multi.cpp
+
+struct options_t {
+    int keccak_ii = 1;          // KECCAK_ROUND_II
+    int banks = 8;              // POLY_BANKS
+    int ntt_stream = 0;         // 0: banked ntt_forward, P: NTT_STREAMING with NTT_STREAM_LANES=P
+    bool fixed_latency = false; // MLKEM_FIXED_LATENCY
+    bool dataflow = false;
+    std::vector<int> cores = {0, 1, 2, 4};
+    int jobs = 1000;
+    double rate = 0;            // keys/s, 0: one job list at t = 0
+    int ctrl_cycles = 0;
+    double clock_mhz = 150;
+    std::string rpt = "../reports/hls_compile.rpt";
+    unsigned seed = 1;
+};
+
+// ============================================================================
+// CALIBRATION
+// ============================================================================
+
+// Defaults are the values fitted to the committed reports/hls_compile.rpt
+struct calib_t {
+    double call = 2;        // Pipeline wrapper / sub-module call over its loop
+    double fill = -1;       // Loop latency minus (n - 1) * II + iteration latency
+    double glue = 1.5;      // Per sub-module call in a sequential parent
+    int keccak_depth = 2;   // Iteration latency of a Keccak round at II=1
+    int ntt_depth = 5;      // Butterfly iteration latency
+    int cbd_depth = 2;
+    int lane_depth = 1;     // Absorb / squeeze lane loops
+    int pack_depth = 2;     // Beat write + H(pk) absorb loop
+    const char* src = "built-in";
+};
+
+struct rpt_row_t {
+    int level;
+    bool loop;
+    std::string name;
+    long lat, iter, ii, trip;
+    std::vector<int> kids;
+};
+
+static long rpt_num(std::string s) {
+    s.erase(0, s.find_first_not_of(' '));
+    if (s.empty() || !isdigit((unsigned char)s[0]))
+        return -1;
+    return atol(s.c_str());
+}
+
+// Rows of the "Performance & Resource Estimates" table
+static std::vector<rpt_row_t> rpt_parse(const std::string& path) {
+    std::vector<rpt_row_t> rows;
+    std::ifstream f(path);
+    std::string line;
+    bool in_table = false;
+    while (std::getline(f, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.find("Modules") != std::string::npos && line.find('|') != std::string::npos) {
+            in_table = true;
+            continue;
+        }
+        if (!in_table)
+            continue;
+        size_t bar = line.find('|');
+        if (bar == std::string::npos) {
+            if (!rows.empty())
+                break;
+            continue;
+        }
+        std::vector<std::string> col;
+        std::stringstream ss(line.substr(bar + 1));
+        std::string c;
+        while (std::getline(ss, c, '|'))
+            col.push_back(c);
+        if (col.size() < 9)
+            continue;
+        size_t mark = col[0].find_first_of("+o");
+        if (mark == std::string::npos || mark + 1 >= col[0].size() || col[0][mark + 1] != ' ')
+            continue;
+        rpt_row_t r;
+        r.level = (int)mark;
+        r.loop = col[0][mark] == 'o';
+        std::string name = col[0].substr(mark + 2);
+        name.erase(name.find_last_not_of(' ') + 1);
+        r.name = name;
+        r.lat = rpt_num(col[3]);
+        r.iter = rpt_num(col[5]);
+        r.ii = rpt_num(col[6]);
+        r.trip = rpt_num(col[7]);
+        rows.push_back(r);
+    }
+
+    // Children: the following rows one level deeper, until the level drops back
+    for (size_t i = 0; i < rows.size(); i++)
+        for (size_t j = i + 1; j < rows.size() && rows[j].level > rows[i].level; j++)
+            if (rows[j].level == rows[i].level + 1)
+                rows[i].kids.push_back((int)j);
+    return rows;
+}
+
+static double median(std::vector<double> v) {
+    std::sort(v.begin(), v.end());
+    size_t n = v.size();
+    return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+static bool loop_known(const rpt_row_t& r) {
+    return r.loop && r.lat >= 0 && r.iter > 0 && r.ii > 0 && r.trip > 0;
+}
+
+// Iteration latency of the loop directly under the first module named `name`
+static int rpt_depth(const std::vector<rpt_row_t>& rows, const char* name, int fallback) {
+    for (size_t i = 0; i < rows.size(); i++)
+        if (!rows[i].loop && rows[i].name.compare(0, strlen(name), name) == 0)
+            for (size_t k = 0; k < rows[i].kids.size(); k++)
+                if (loop_known(rows[rows[i].kids[k]]))
+                    return (int)rows[rows[i].kids[k]].iter;
+    return fallback;
+}
+
+static double loop_model(const calib_t& cal, long trips, long ii, long depth) {
+    return (trips - 1) * ii + std::max(depth + cal.fill, 1.0);
+}
+
+// A sequential parent: the summed latency of its sub-modules and how many
+// times that sequence runs. The report lists a sub-module once however
+// often an unrolled loop calls it (polyvec_cbd_eta1 runs poly_cbd_eta1 K
+// times), so the count is the whole number of repetitions that fits.
+static bool module_seq(const std::vector<rpt_row_t>& rows, const rpt_row_t& m, double& sum, int& calls) {
+    sum = 0;
+    for (size_t k = 0; k < m.kids.size(); k++) {
+        const rpt_row_t& c = rows[m.kids[k]];
+        if (c.loop || c.lat <= 0)
+            return false;
+        sum += c.lat;
+    }
+    if (m.kids.empty() || m.lat < sum)
+        return false;
+    calls = (int)(m.lat / sum);
+    return true;
+}
+
+// Module latency predicted from its children: wrapper around one loop, or
+// a sequence of sub-module calls. -1 if the row is neither.
+static double module_model(const std::vector<rpt_row_t>& rows, const rpt_row_t& m, const calib_t& cal) {
+    if (m.kids.size() == 1 && loop_known(rows[m.kids[0]])) {
+        const rpt_row_t& l = rows[m.kids[0]];
+        return cal.call + loop_model(cal, l.trip, l.ii, l.iter);
+    }
+    double sum;
+    int calls;
+    if (!module_seq(rows, m, sum, calls))
+        return -1;
+    return calls * (sum + m.kids.size() * cal.glue);
+}
+
+static calib_t calibrate(const std::string& path) {
+    calib_t cal;
+    std::vector<rpt_row_t> rows = rpt_parse(path);
+    if (rows.empty()) {
+        printf("Calibration: %s not found or empty, using built-in constants\n\n", path.c_str());
+        return cal;
+    }
+
+    std::vector<double> fill, call, glue;
+    for (size_t i = 0; i < rows.size(); i++) {
+        const rpt_row_t& r = rows[i];
+        if (loop_known(r) && r.iter > 1)
+            fill.push_back(r.lat - ((r.trip - 1) * r.ii + r.iter));
+        if (r.loop || r.lat < 0 || r.kids.empty())
+            continue;
+        if (r.kids.size() == 1 && loop_known(rows[r.kids[0]])) {
+            call.push_back(r.lat - rows[r.kids[0]].lat);
+            continue;
+        }
+        double sum;
+        int calls;
+        if (module_seq(rows, r, sum, calls))
+            glue.push_back((r.lat - calls * sum) / (calls * r.kids.size()));
+    }
+    if (!fill.empty()) cal.fill = median(fill);
+    if (!call.empty()) cal.call = median(call);
+    if (!glue.empty()) cal.glue = median(glue);
+    cal.keccak_depth = rpt_depth(rows, "keccak_f1600", cal.keccak_depth);
+    cal.ntt_depth = rpt_depth(rows, "ntt_forward", cal.ntt_depth);
+    cal.cbd_depth = rpt_depth(rows, "poly_cbd_eta1", cal.cbd_depth);
+    cal.lane_depth = rpt_depth(rows, "shake128_Pipeline", cal.lane_depth);
+    cal.pack_depth = rpt_depth(rows, "mlkem512_keygen_top_Pipeline", cal.pack_depth);
+    cal.src = "report";
+
+    printf("Calibration against %s\n", path.c_str());
+    printf("  wrapper overhead %.1f, loop fill %+.1f, call glue %.2f (medians of %zu, %zu, %zu rows)\n",
+           cal.call, cal.fill, cal.glue, call.size(), fill.size(), glue.size());
+    printf("  iteration depth: keccak round %d, NTT butterfly %d, CBD %d, lane loops %d, pack %d\n\n",
+           cal.keccak_depth, cal.ntt_depth, cal.cbd_depth, cal.lane_depth, cal.pack_depth);
+
+    // Every module row the fitted model reproduces, once per distinct name
+    printf("  %-46s %8s %8s %7s\n", "module", "report", "model", "error");
+    std::vector<std::string> seen;
+    double abs_err = 0;
+    int n = 0;
+    for (size_t i = 0; i < rows.size(); i++) {
+        const rpt_row_t& r = rows[i];
+        if (r.loop || r.lat < 0 || std::find(seen.begin(), seen.end(), r.name) != seen.end())
+            continue;
+        double m = module_model(rows, r, cal);
+        if (m < 0)
+            continue;
+        seen.push_back(r.name);
+        double err = (m - r.lat) / r.lat;
+        abs_err += fabs(err);
+        n++;
+        printf("  %-46s %8ld %8.0f %+6.1f%%\n", r.name.c_str(), r.lat, m, 100 * err);
+    }
+    if (n)
+        printf("  mean |error| %.1f%% over %d modules\n\n", 100 * abs_err / n, n);
+    return cal;
+}
+
+// ============================================================================
+// STAGE MODEL
+// ============================================================================
+
+enum stage_id_t { ST_G, ST_MATRIX, ST_PRF_S, ST_CBD_S, ST_PRF_E, ST_CBD_E, ST_NTT_S, ST_NTT_E,
+                  ST_BASEMUL, ST_ADD, ST_PACK, ST_COUNT };
+
+struct stage_t {
+    const char* name;
+    std::vector<int> deps;  // Stages whose outputs it reads
+    double cycles;
+    long trips;             // As counted by CT_TRIP in csim
+};
+
+struct model_t {
+    const options_t& opt;
+    const calib_t& cal;
+
+    // Pipelined loop in its own module (function or Vitis pipeline wrapper)
+    double pipe(long trips, long ii, long depth) const {
+        return cal.call + loop_model(cal, trips, ii, depth);
+    }
+
+    double keccak() const {
+        return pipe(24, opt.keccak_ii, cal.keccak_depth + opt.keccak_ii - 1) + cal.glue;
+    }
+
+    // One-block absorb, then out_bytes squeezed a block at a time
+    double sponge(int rate_lanes, int out_bytes, long& trips) const {
+        double c = pipe(rate_lanes, 1, cal.lane_depth) + keccak();
+        trips += rate_lanes + 24;
+        for (int pos = 0; pos < out_bytes; pos += rate_lanes * 8) {
+            int lanes = std::min(rate_lanes, (out_bytes - pos + 7) / 8);
+            c += pipe(lanes, 1, cal.lane_depth);
+            trips += lanes;
+            if (pos + rate_lanes * 8 < out_bytes) {
+                c += keccak();
+                trips += 24;
+            }
+        }
+        return c + cal.glue;
+    }
+
+    double ntt(long& trips) const {
+        if (!opt.ntt_stream) {
+            int iters = N / 2 / opt.banks;
+            trips += K * NTT_LAYERS * iters;
+            return K * NTT_LAYERS * (pipe(iters, 2, cal.ntt_depth) + cal.glue);
+        }
+        // Copy in, then feed -> 7 layer processes -> drain as one dataflow
+        // region: the stream rate sets the throughput and every delay-line
+        // layer (L >= P) adds its D = L / P to the latency
+        int p = opt.ntt_stream;
+        int vecs = K * N / p;
+        double c = K * N / opt.banks + vecs;
+        for (int l = N / 2; l >= 2; l /= 2) {
+            int d = l >= p ? l / p : 0;
+            c += d + cal.ntt_depth + cal.call;
+            trips += vecs + d;
+        }
+        return c + 2 * (cal.lane_depth + cal.call) + cal.glue;
+    }
+
+    // Stage cycles and trips of one job; rej[i] = rejection loop trips of A entry i
+    std::vector<stage_t> stages(const std::vector<int>& rej) const {
+        std::vector<stage_t> s(ST_COUNT);
+        int basemul_lanes = opt.banks / 4;
+        int basemul_iters = N / 4 / basemul_lanes;
+        int basemul_depth = cal.ntt_depth + 2;      // Two chained products, then accumulate
+        int elem_depth = 2;                         // Add / pack: one conditional subtraction
+
+        s[ST_G] = {"G", {}, 0, 0};
+        s[ST_G].cycles = pipe(SHA3_512_RATE_LANES, 1, cal.lane_depth) + keccak() + pipe(64, 1, cal.lane_depth) +
+                         2 * cal.glue;
+        s[ST_G].trips = SHA3_512_RATE_LANES + 24;
+
+        s[ST_MATRIX] = {"matrix", {ST_G}, 0, 0};
+        for (int i = 0; i < K * K; i++) {
+            // Absorb, then squeeze a block (permuting before all but the
+            // first) and scan it, until rej[i] trips are done
+            double c = pipe(SHAKE128_RATE_LANES, 1, cal.lane_depth) + keccak();
+            long trips = SHAKE128_RATE_LANES + 24;
+            for (int done = 0; done < rej[i]; done += REJ_BLOCK_TRIPS) {
+                int n = std::min(REJ_BLOCK_TRIPS, rej[i] - done);
+                if (done > 0) {
+                    c += keccak();
+                    trips += 24;
+                }
+                c += pipe(SHAKE128_RATE_LANES, 1, cal.lane_depth) + pipe(n, 1, elem_depth);
+                trips += SHAKE128_RATE_LANES + n;
+            }
+            s[ST_MATRIX].cycles += c + 2 * cal.glue;
+            s[ST_MATRIX].trips += trips;
+        }
+
+        // The K + 1 calls for s include the unused prf_buf_s1 one
+        s[ST_PRF_S] = {"PRF_s", {ST_G}, 0, 0};
+        s[ST_PRF_E] = {"PRF_e", {ST_G}, 0, 0};
+        for (int i = 0; i < K + 1; i++)
+            s[ST_PRF_S].cycles += sponge(SHAKE256_RATE_LANES, PRF_BYTES, s[ST_PRF_S].trips) + cal.glue;
+        for (int i = 0; i < K; i++)
+            s[ST_PRF_E].cycles += sponge(SHAKE256_RATE_LANES, PRF_BYTES, s[ST_PRF_E].trips) + cal.glue;
+
+        s[ST_CBD_S] = {"CBD_s", {ST_PRF_S}, K * (pipe(N / 4, 1, cal.cbd_depth) + cal.glue), K * N / 4};
+        s[ST_CBD_E] = {"CBD_e", {ST_PRF_E}, s[ST_CBD_S].cycles, K * N / 4};
+
+        s[ST_NTT_S] = {"NTT_s", {ST_CBD_S}, 0, 0};
+        s[ST_NTT_E] = {"NTT_e", {ST_CBD_E}, 0, 0};
+        s[ST_NTT_S].cycles = ntt(s[ST_NTT_S].trips);
+        s[ST_NTT_E].cycles = ntt(s[ST_NTT_E].trips);
+
+        s[ST_BASEMUL] = {"basemul", {ST_MATRIX, ST_NTT_S}, 0, 2L * K * basemul_iters};
+        s[ST_BASEMUL].cycles = K * (pipe(basemul_iters, 1, basemul_depth) + cal.glue) +
+                               K * (pipe(basemul_iters, 1, basemul_depth) + cal.glue);
+
+        s[ST_ADD] = {"add", {ST_BASEMUL, ST_NTT_E}, K * (pipe(N / opt.banks, 1, elem_depth) + cal.glue), 0};
+
+        // pk beats and rho, PK_HASH_BLOCKS absorb loops with a permutation
+        // after all but the last, sk beats, final permutation, H(pk) and z
+        s[ST_PACK] = {"pack+H", {ST_ADD, ST_NTT_S, ST_G}, 0, 0};
+        double c = K * pipe(POLY_TOBEATS_ITERS, 1, elem_depth) + pipe(SYMBEATS, 1, cal.lane_depth);
+        c += PK_HASH_BLOCKS * pipe(SHA3_256_RATE_LANES, 1, cal.pack_depth) + (PK_HASH_BLOCKS - 1) * keccak();
+        c += K * pipe(POLY_TOBEATS_ITERS, 1, elem_depth) + keccak() + 2 * pipe(SYMBEATS, 1, cal.lane_depth);
+        s[ST_PACK].cycles = c + 4 * cal.glue;
+        s[ST_PACK].trips = PK_HASH_BLOCKS * (SHA3_256_RATE_LANES + 24);
+        return s;
+    }
+};
+
+// Start and finish of every stage; returns the job latency
+static double schedule(const std::vector<stage_t>& s, bool dataflow, std::vector<double>& start,
+                       std::vector<double>& finish) {
+    start.assign(s.size(), 0);
+    finish.assign(s.size(), 0);
+    double t = 0;
+    for (size_t i = 0; i < s.size(); i++) {
+        double ready = dataflow ? 0 : t;
+        for (size_t k = 0; k < s[i].deps.size(); k++)
+            ready = std::max(ready, finish[s[i].deps[k]]);
+        start[i] = ready;
+        finish[i] = ready + s[i].cycles;
+        t = std::max(t, finish[i]);
+    }
+    return t;
+}
+
+// Rejection sampling trips for one A entry: three bytes (two candidates)
+// per trip until N coefficients are accepted; known-latency mode scans
+// REJ_UNIFORM_FIXED_BLOCKS blocks in full
+static int rej_trips(std::mt19937_64& rng, bool fixed_latency) {
+    if (fixed_latency)
+        return REJ_UNIFORM_FIXED_BLOCKS * REJ_BLOCK_TRIPS;
+    std::uniform_int_distribution<int> cand(0, 4095);
+    int ctr = 0, t = 0;
+    while (ctr < N) {
+        t++;
+        ctr += cand(rng) < Q;
+        if (ctr < N)
+            ctr += cand(rng) < Q;
+    }
+    return t;
+}
+
+// ============================================================================
+// BATCH SIMULATION
+// ============================================================================
+
+struct batch_t {
+    double makespan, mean_lat, p50_lat, p99_lat, max_lat, mean_wait, p99_wait;
+    int max_queue;
+    double core_util, collect_util;
+};
+
+static double pct(std::vector<double> v, double p) {
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t)(p * v.size()))];
+}
+
+// arrive / service in cycles; cores = 0: the single-core top
+static batch_t simulate(const std::vector<double>& arrive, const std::vector<double>& service, int cores,
+                        int ctrl_cycles) {
+    size_t n = arrive.size();
+    std::vector<double> start(n), done(n);
+    double busy = 0, collect_busy = 0;
+
+    if (cores == 0) {
+        double free_at = 0;
+        for (size_t i = 0; i < n; i++) {
+            start[i] = std::max(arrive[i], free_at);
+            done[i] = start[i] + ctrl_cycles + service[i];
+            free_at = done[i];
+            busy += ctrl_cycles + service[i];
+        }
+    } else {
+        // Core work per job beyond keygen: read 8 job beats, unpack d and z,
+        // write the 304 key beats into its key FIFO
+        const double core_extra = KEYGEN_JOB_BEATS + 2 * SYMBEATS + KEYGEN_KEY_BEATS;
+        const int fifo_jobs = JOB_FIFO_BEATS / KEYGEN_JOB_BEATS;
+        std::vector<double> dispatched(n), core_end(n);
+        double dispatch_free = 0, collect_free = 0;
+        for (size_t i = 0; i < n; i++) {
+            // In-order dispatch: blocks while this core's job FIFO is full
+            double d = std::max(arrive[i], dispatch_free);
+            if (i >= (size_t)(fifo_jobs * cores))
+                d = std::max(d, start[i - fifo_jobs * cores]);
+            dispatched[i] = d + KEYGEN_JOB_BEATS;
+            dispatch_free = dispatched[i];
+
+            start[i] = std::max(dispatched[i], i >= (size_t)cores ? core_end[i - cores] : 0.0);
+            core_end[i] = start[i] + service[i] + core_extra;
+            // The key FIFO holds one keypair: the core's writes of this one
+            // finish only once the collector has taken its previous one
+            if (i >= (size_t)cores)
+                core_end[i] = std::max(core_end[i], done[i - cores]);
+            busy += service[i] + core_extra;
+
+            // Collector: in job order, one beat per cycle
+            double cs = std::max(collect_free, core_end[i] - KEYGEN_KEY_BEATS);
+            done[i] = std::max(cs + KEYGEN_KEY_BEATS, core_end[i]);
+            collect_free = done[i];
+            collect_busy += KEYGEN_KEY_BEATS;
+        }
+    }
+
+    batch_t b;
+    std::vector<double> lat(n), wait(n);
+    double first = *std::min_element(arrive.begin(), arrive.end());
+    b.makespan = *std::max_element(done.begin(), done.end()) - first;
+    for (size_t i = 0; i < n; i++) {
+        lat[i] = done[i] - arrive[i];
+        wait[i] = start[i] - arrive[i];
+    }
+    b.mean_lat = 0;
+    b.mean_wait = 0;
+    for (size_t i = 0; i < n; i++) {
+        b.mean_lat += lat[i] / n;
+        b.mean_wait += wait[i] / n;
+    }
+    b.p50_lat = pct(lat, 0.5);
+    b.p99_lat = pct(lat, 0.99);
+    b.max_lat = pct(lat, 1.0);
+    b.p99_wait = pct(wait, 0.99);
+
+    // Jobs arrived but not yet started, sampled at every arrival
+    std::vector<std::pair<double, int> > ev;
+    for (size_t i = 0; i < n; i++) {
+        ev.push_back(std::make_pair(arrive[i], +1));
+        ev.push_back(std::make_pair(start[i], -1));
+    }
+    std::sort(ev.begin(), ev.end(), [](const std::pair<double, int>& a, const std::pair<double, int>& b) {
+        return a.first < b.first || (a.first == b.first && a.second < b.second);
+    });
+    int q = 0;
+    b.max_queue = 0;
+    for (size_t i = 0; i < ev.size(); i++) {
+        q += ev[i].second;
+        b.max_queue = std::max(b.max_queue, q);
+    }
+
+    b.core_util = busy / (std::max(cores, 1) * b.makespan);
+    b.collect_util = cores ? collect_busy / b.makespan : 0;
+    return b;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [--keccak-ii N] [--banks 4|8|16] [--ntt-stream P] [--fixed-latency] [--dataflow]\n"
+            "       [--cores 0,1,2,4] [--jobs N] [--rate keys/s] [--ctrl-cycles N] [--clock MHz]\n"
+            "       [--rpt file] [--seed N]\n",
+            prog);
+    exit(1);
+}
+
+static void parse_args(int argc, char** argv, options_t& o) {
+    // Clock target from hls_config.cfg when run from HLS/
+    std::ifstream cfg("hls_config.cfg");
+    std::string line;
+    while (std::getline(cfg, line))
+        if (line.compare(0, 6, "clock=") == 0)
+            o.clock_mhz = atof(line.c_str() + 6);
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        bool has_val = i + 1 < argc;
+        if (a == "--fixed-latency") {
+            o.fixed_latency = true;
+        } else if (a == "--dataflow") {
+            o.dataflow = true;
+        } else if (!has_val) {
+            usage(argv[0]);
+        } else if (a == "--keccak-ii") {
+            o.keccak_ii = atoi(argv[++i]);
+        } else if (a == "--banks") {
+            o.banks = atoi(argv[++i]);
+        } else if (a == "--ntt-stream") {
+            o.ntt_stream = atoi(argv[++i]);
+        } else if (a == "--cores") {
+            o.cores.clear();
+            std::stringstream ss(argv[++i]);
+            std::string c;
+            while (std::getline(ss, c, ','))
+                o.cores.push_back(atoi(c.c_str()));
+        } else if (a == "--jobs") {
+            o.jobs = atoi(argv[++i]);
+        } else if (a == "--rate") {
+            o.rate = atof(argv[++i]);
+        } else if (a == "--ctrl-cycles") {
+            o.ctrl_cycles = atoi(argv[++i]);
+        } else if (a == "--clock") {
+            o.clock_mhz = atof(argv[++i]);
+        } else if (a == "--rpt") {
+            o.rpt = argv[++i];
+        } else if (a == "--seed") {
+            o.seed = (unsigned)atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    if (o.banks != 4 && o.banks != 8 && o.banks != 16) {
+        fprintf(stderr, "--banks must be 4, 8 or 16 (POLY_BANKS)\n");
+        exit(1);
+    }
+    if (o.ntt_stream < 0 || (o.ntt_stream & (o.ntt_stream - 1)) || o.ntt_stream > o.banks) {
+        fprintf(stderr, "--ntt-stream must be a power of two up to --banks (NTT_STREAM_LANES)\n");
+        exit(1);
+    }
+    if (o.keccak_ii < 1 || o.jobs < 1 || o.clock_mhz <= 0 || o.rate < 0 || o.cores.empty()) {
+        fprintf(stderr, "invalid --keccak-ii, --jobs, --clock, --rate or --cores\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < o.cores.size(); i++)
+        if (o.cores[i] < 0) {
+            fprintf(stderr, "--cores takes counts >= 0 (0: mlkem512_keygen_top)\n");
+            exit(1);
+        }
+}
+
+int main(int argc, char** argv) {
+    options_t opt;
+    parse_args(argc, argv, opt);
+    calib_t cal = calibrate(opt.rpt);
+    model_t model = {opt, cal};
+    double us_per_cycle = 1 / opt.clock_mhz;
+
+    std::string ntt = opt.ntt_stream ? "streaming x" + std::to_string(opt.ntt_stream) : "banked";
+    printf("Design: KECCAK_ROUND_II=%d POLY_BANKS=%d NTT=%s MLKEM_FIXED_LATENCY=%d\n", opt.keccak_ii,
+           opt.banks, ntt.c_str(), (int)opt.fixed_latency);
+    printf("        %s schedule, %.0f MHz, %s calibration\n\n", opt.dataflow ? "dataflow" : "sequential",
+           opt.clock_mhz, cal.src);
+
+    // Every job's service time, with its own rejection sampling
+    std::mt19937_64 rng(opt.seed);
+    std::vector<double> service(opt.jobs);
+    std::vector<double> start, finish;
+    std::vector<double> rej_mean(K * K, 0);
+    for (int j = 0; j < opt.jobs; j++) {
+        std::vector<int> rej(K * K);
+        for (int i = 0; i < K * K; i++) {
+            rej[i] = rej_trips(rng, opt.fixed_latency);
+            rej_mean[i] += (double)rej[i] / opt.jobs;
+        }
+        service[j] = schedule(model.stages(rej), opt.dataflow, start, finish);
+    }
+
+    // Stage table for a job with the mean rejection trip counts
+    std::vector<int> rej_typ(K * K);
+    for (int i = 0; i < K * K; i++)
+        rej_typ[i] = (int)lround(rej_mean[i]);
+    std::vector<stage_t> st = model.stages(rej_typ);
+    double latency = schedule(st, opt.dataflow, start, finish);
+
+    // Critical path: walk back from the last stage through the dependency
+    // (or, sequentially, the previous stage) that finished last
+    std::vector<bool> critical(st.size(), false);
+    for (int i = ST_COUNT - 1; i >= 0;) {
+        critical[i] = true;
+        int prev = -1;
+        for (size_t k = 0; k < st[i].deps.size(); k++)
+            if (prev < 0 || finish[st[i].deps[k]] > finish[prev])
+                prev = st[i].deps[k];
+        if (!opt.dataflow && i > 0 && (prev < 0 || finish[i - 1] >= finish[prev]))
+            prev = i - 1;
+        if (prev < 0 || finish[prev] < start[i])
+            break;
+        i = prev;
+    }
+
+    printf("%-8s %8s %8s %8s %8s %6s  %s\n", "stage", "trips", "cycles", "start", "finish", "share", "after");
+    for (size_t i = 0; i < st.size(); i++) {
+        std::string deps;
+        for (size_t k = 0; k < st[i].deps.size(); k++)
+            deps += (k ? ", " : "") + std::string(st[st[i].deps[k]].name);
+        printf("%-8s %8ld %8.0f %8.0f %8.0f %5.1f%%%s %s\n", st[i].name, st[i].trips, st[i].cycles, start[i],
+               finish[i], 100 * st[i].cycles / latency, critical[i] ? "*" : " ", deps.c_str());
+    }
+    double mean_service = 0;
+    for (int j = 0; j < opt.jobs; j++)
+        mean_service += service[j] / opt.jobs;
+    printf("\nKeygen latency: %.0f cycles (%.1f us), %.0f mean over %d jobs; * = critical path\n"
+           "One core back to back: %.0f keys/s\n\n",
+           latency, latency * us_per_cycle, mean_service, opt.jobs, opt.clock_mhz * 1e6 / mean_service);
+
+    // Arrivals: one job list at t = 0, or Poisson at --rate
+    std::vector<double> arrive(opt.jobs, 0);
+    if (opt.rate > 0) {
+        std::exponential_distribution<double> gap(opt.rate / (opt.clock_mhz * 1e6));
+        double t = 0;
+        for (int j = 0; j < opt.jobs; j++) {
+            t += gap(rng);
+            arrive[j] = t;
+        }
+    }
+
+    if (opt.rate > 0)
+        printf("Batch: %d jobs, Poisson arrivals at %.0f keys/s\n", opt.jobs, opt.rate);
+    else
+        printf("Batch: %d jobs submitted at once\n", opt.jobs);
+    printf("%-10s %10s %10s %10s %10s %10s %10s %9s %7s %9s\n", "top", "keys/s", "lat mean", "lat p50",
+           "lat p99", "wait mean", "wait p99", "max queue", "core %", "collect %");
+    for (size_t c = 0; c < opt.cores.size(); c++) {
+        batch_t b = simulate(arrive, service, opt.cores[c], opt.ctrl_cycles);
+        std::string top = opt.cores[c] ? "multi x" + std::to_string(opt.cores[c]) : "single";
+        printf("%-10s %10.0f %10.1f %10.1f %10.1f %10.1f %10.1f %9d %6.1f%% %8.1f%%\n", top.c_str(),
+               opt.jobs * opt.clock_mhz * 1e6 / b.makespan, b.mean_lat * us_per_cycle, b.p50_lat * us_per_cycle,
+               b.p99_lat * us_per_cycle, b.mean_wait * us_per_cycle, b.p99_wait * us_per_cycle, b.max_queue,
+               100 * b.core_util, 100 * b.collect_util);
+    }
+    printf("(latencies in us from arrival to the keypair written)\n");
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include "unified.h"
+
+// Batched public-key validation.
+//
+// One flattened pipeline over every beat of every key, one beat per cycle,
+// so keys follow each other with no drain in between. Beats are collected
+// in groups of three and decoded as in poly_frombeats: two 96-bit words of
+// eight 12-bit coefficients each. Each coefficient is only compared with q;
+// nothing is stored or re-encoded. The trailing rho beats are read but
+// carry no coefficients.
+
+// True if all eight 12-bit fields of w are below q
+static bool word96_below_q(word96_t w) {
+#pragma HLS INLINE
+    bool ok = true;
+    for (int j = 0; j < 8; j++) {
+#pragma HLS UNROLL
+        ok &= (ap_uint<12>)(w >> (12 * j)) < MLKEM_Q;
+    }
+    return ok;
+}
+
+int mlkem512_pk_check_top(const beat_t* pks, int npks, ap_uint<32>* valid) {
+#pragma HLS INTERFACE m_axi port=pks offset=slave bundle=gmem0 depth=6400
+#pragma HLS INTERFACE m_axi port=valid offset=slave bundle=gmem1 depth=2
+#pragma HLS INTERFACE s_axilite port=pks bundle=control
+#pragma HLS INTERFACE s_axilite port=npks bundle=control
+#pragma HLS INTERFACE s_axilite port=valid bundle=control
+#pragma HLS INTERFACE s_axilite port=return bundle=control
+
+    beat_t b0 = 0, b1 = 0;
+    int beat = 0;           // Beat within the current key
+    int group = 0;          // Beat within the current 3-beat group
+    int key = 0;
+    bool key_ok = true;
+    ap_uint<32> word = 0;
+    int invalid = 0;
+
+    for (int i = 0; i < npks * MLKEM_PUBLICKEYBEATS; i++) {
+#pragma HLS LOOP_TRIPCOUNT min=100 max=6400
+#pragma HLS PIPELINE II=1
+        beat_t b2 = pks[i];
+
+        if (beat < PK_CHECK_POLY_BEATS && group == PK_CHECK_GROUP_BEATS - 1) {
+            word96_t lo = (word96_t)b0 | ((word96_t)(b1 & 0xFFFFFFFF) << 64);
+            word96_t hi = (word96_t)(b1 >> 32) | ((word96_t)b2 << 32);
+            key_ok &= word96_below_q(lo) && word96_below_q(hi);
+        }
+        b0 = b1;
+        b1 = b2;
+        group = (group == PK_CHECK_GROUP_BEATS - 1) ? 0 : group + 1;
+
+        if (beat == MLKEM_PUBLICKEYBEATS - 1) {
+            // Key done: record it, flushing the bitmap word when full
+            word |= (ap_uint<32>)key_ok << (key % 32);
+            if (!key_ok)
+                invalid++;
+            if (key % 32 == 31 || key == npks - 1) {
+                valid[key / 32] = word;
+                word = 0;
+            }
+            key++;
+            key_ok = true;
+            beat = 0;
+            group = 0;
+        } else {
+            beat++;
+        }
+    }
+
+    return invalid;
+}
@@ -14,6 +14,34 @@ coeff_t barrett_reduce(coeff_t a) {
     return a - t * MLKEM_Q;
 }
 
+// Barrett reduction of a product of two coefficients (< 2^24) to [0, q):
+// the quotient estimate floor(a * floor(2^24 / q) / 2^24) is off by at most
+// one, so a single conditional subtraction finishes the job
+coeff_t barrett_reduce24(coeff_prod_t a) {
+#pragma HLS INLINE
+    ap_uint<13> t = ((ap_uint<37>)a * 5039) >> 24;
+    coeff_sum_t r = a - (coeff_prod_t)t * MLKEM_Q;
+    return csubq(r);
+}
+
+// Barrett reduction of a lazy sum of products (< 2^27) to [0, q): same
+// scheme as barrett_reduce24 with floor(2^32 / q), quotient off by at most one
+coeff_t barrett_reduce_acc(coeff_acc_t a) {
+#pragma HLS INLINE
+    ap_uint<16> t = ((ap_uint<48>)a * 1290167) >> 32;
+    coeff_sum_t r = a - (coeff_acc_t)t * MLKEM_Q;
+    return csubq(r);
+}
+
+// Montgomery reduction of a product below q * 2^16 to [0, q): returns
+// a * 2^-16 mod q. Used with Montgomery-form twiddles, where the 2^16 cancels.
+coeff_t montgomery_reduce24(coeff_prod_t a) {
+#pragma HLS INLINE
+    ap_uint<16> m = (ap_uint<16>)a * QINV_NEG;
+    coeff_sum_t u = ((ap_uint<29>)a + (ap_uint<28>)m * MLKEM_Q) >> 16;
+    return csubq(u);
+}
+
 // Conditional subtraction
 coeff_t csubq(coeff_t a) {
 #pragma HLS INLINE
@@ -34,119 +62,225 @@ ap_uint<8> reverse_bits(ap_uint<8> x, int bits) {
 }
 const int N=256;
 const int MOD = 3329;
-// NTT forward transform
+// NTT forward transform, coefficients in [0, q) in and out
 
 void ntt_forward(poly_t* r) {
-   int k = 1;
-    
-    for (int l = 128; l >= 2; l = l >> 1) {        
-        for (int start = 0; start < 256; start = start + 2 * l) {
-            #pragma HLS UNROLL
-            ap_uint<16> zeta = ntt_zetas[k];
-            k = k + 1;
-            
-            for (int j = start; j < start + l; j++) {
-                #pragma HLS UNROLL
-                ap_uint<32> t = (ap_uint<32>)zeta * r->coeffs[j + l];
-                ap_uint<16> t_mod = t % MOD;
-                
-                ap_uint<32> diff = (ap_uint<32>)r->coeffs[j] + MOD - t_mod;
-                r->coeffs[j + l] = diff % MOD;
-                
-                ap_uint<32> sum = (ap_uint<32>)r->coeffs[j] + t_mod;
-                r->coeffs[j] = sum % MOD;
+#pragma HLS INLINE off
+    POLY_BANKED(r->coeffs)
+    TWIDDLE_BANKED(ntt_fwd_rom)
+
+    // Layer s has len = 128 >> s. Layers are unrolled so that each copy has a
+    // constant stride and every access resolves to a fixed bank; within a
+    // layer NTT_BUTTERFLIES butterflies run per iteration. Each bank serves two
+    // reads and two writes per iteration over its two ports, hence II=2.
+    for (int s = 0; s < NTT_LAYERS; s++) {
+#pragma HLS UNROLL
+        int l = 128 >> s;
+
+        for (int b = 0; b < MLKEM_N / 2; b += NTT_BUTTERFLIES) {
+#pragma HLS PIPELINE II=2
+            CT_TRIP();
+            for (int u = 0; u < NTT_BUTTERFLIES; u++) {
+#pragma HLS UNROLL
+                int bi = b + u;
+                int j = ((bi >> (7 - s)) << (8 - s)) + (bi & (l - 1));
+                coeff_t zeta = ntt_fwd_rom.v[u][s * NTT_LANE_ITERS + b / NTT_BUTTERFLIES];
+
+                // Registered DSP product, Montgomery reduction, then 13-bit
+                // add/sub with one conditional subtraction each: no dividers
+                coeff_prod_t t = (coeff_prod_t)zeta * r->coeffs[j + l];
+#pragma HLS BIND_OP variable=t op=mul impl=dsp latency=2
+                coeff_q_t t_mod(montgomery_reduce24(t));
+                coeff_q_t a(r->coeffs[j]);
+
+                r->coeffs[j + l] = bounded_reduce(a - t_mod).v;
+                r->coeffs[j] = bounded_reduce(a + t_mod).v;
             }
         }
     }
-    
-    // Final modular reduction (optional since we're doing it in the loop)
-    for (int j = 0; j < 256; j++) {
-        r->coeffs[j] = barrett_reduce( r->coeffs[j]) ;
-    }
 
+    // Inputs below q keep every butterfly output below q, so no final
+    // reduction pass is needed
 }
 
+// NTT inverse transform
+void ntt_inverse(poly_t* r) {
+#pragma HLS INLINE off
+    POLY_BANKED(r->coeffs)
+    TWIDDLE_BANKED(ntt_inv_rom)
 
-// Base multiplication function for 2 coefficients and zeta
-void ntt_base_multiplication(int16_t *r0, int16_t *r1,
-                                           int16_t a0, int16_t a1,
-                                           int16_t b0, int16_t b1,
-                                           int16_t zeta) {
-    int32_t t0 = (int32_t)a0 * b0;
-    int32_t t1 = (int32_t)zeta * a1 % MLKEM_Q;
-    t1 = t1 * b1 % MLKEM_Q;
-    *r0 = (t0 + t1) % MLKEM_Q;
-
-    int32_t t2 = (int32_t)a1 * b0 + (int32_t)a0 * b1;
-    *r1 = t2 % MLKEM_Q;
-}
-
-// Perform base-wise multiplication using NTT with zeta coefficients
-void poly_basemul_montgomery(poly_t *r, const poly_t *a, const poly_t *b) {
-    for (int i = 0; i < 64; i++) {
-        int16_t a0 = a->coeffs[4 * i + 0];
-        int16_t a1 = a->coeffs[4 * i + 1];
-        int16_t a2 = a->coeffs[4 * i + 2];
-        int16_t a3 = a->coeffs[4 * i + 3];
+    // Gentleman-Sande butterflies, layers in reverse order (len 2 .. 128),
+    // same banking and butterfly numbering as ntt_forward
+    for (int s = NTT_LAYERS - 1; s >= 0; s--) {
+#pragma HLS UNROLL
+        int l = 128 >> s;
 
-        int16_t b0 = b->coeffs[4 * i + 0];
-        int16_t b1 = b->coeffs[4 * i + 1];
-        int16_t b2 = b->coeffs[4 * i + 2];
-        int16_t b3 = b->coeffs[4 * i + 3];
+        for (int b = 0; b < MLKEM_N / 2; b += NTT_BUTTERFLIES) {
+#pragma HLS PIPELINE II=2
+            for (int u = 0; u < NTT_BUTTERFLIES; u++) {
+#pragma HLS UNROLL
+                int bi = b + u;
+                int j = ((bi >> (7 - s)) << (8 - s)) + (bi & (l - 1));
+                coeff_t zeta = ntt_inv_rom.v[u][s * NTT_LANE_ITERS + b / NTT_BUTTERFLIES];
+
+                coeff_q_t a(r->coeffs[j]);
+                coeff_q_t c(r->coeffs[j + l]);
+                coeff_t d = bounded_reduce(c - a).v;
+                coeff_prod_t t = (coeff_prod_t)zeta * d;
+#pragma HLS BIND_OP variable=t op=mul impl=dsp latency=2
+
+                r->coeffs[j] = bounded_reduce(a + c).v;
+                r->coeffs[j + l] = montgomery_reduce24(t);
+            }
+        }
+    }
 
-        int16_t r0, r1, r2, r3;
+    // Scale by 128^(-1)
+    for (int j = 0; j < MLKEM_N; j += POLY_BANKS) {
+#pragma HLS PIPELINE II=1
+        for (int u = 0; u < POLY_BANKS; u++) {
+#pragma HLS UNROLL
+            r->coeffs[j + u] = montgomery_reduce24((coeff_prod_t)NTT_INV_SCALE_MONT * r->coeffs[j + u]);
+        }
+    }
+}
 
-        // first pair
-        ntt_base_multiplication(&r0, &r1, a0, a1, b0, b1, ntt_zetas[64 + i]);
+// Karatsuba base multiplication of one pair, (a0 + a1 X)(b0 + b1 X) mod
+// (X^2 - zeta), given zb = zeta * b1 mod q and bs = b0 + b1:
+//   r0 = a0 b0 + a1 zb
+//   r1 = (a0 + a1) bs - a0 b0 - a1 b1     (= a0 b1 + a1 b0, never negative)
+// Four multiplications and no reduction; both results are below 2q^2.
+static void basemul_pair_lazy(coeff_acc_t& r0, coeff_acc_t& r1, coeff_t a0, coeff_t a1,
+                              coeff_t b0, coeff_t b1, coeff_t zb, coeff_sum_t bs) {
+#pragma HLS INLINE
+    coeff_prod_t p00 = (coeff_prod_t)a0 * b0;
+    coeff_prod_t p11 = (coeff_prod_t)a1 * b1;
+    coeff_acc_t pk = (coeff_acc_t)(coeff_sum_t)(a0 + a1) * bs;
+    r0 = (coeff_acc_t)p00 + (coeff_prod_t)a1 * zb;
+    r1 = pk - p00 - p11;
+}
 
-        // second pair with -zeta
-        ntt_base_multiplication(&r2, &r3, a2, a3, b2, b3, (MLKEM_Q - ntt_zetas[64 + i]) % MLKEM_Q);
+// Per-pair operand terms of b for basemul_pair_lazy, in b's own layout so
+// each lane reads them from the banks it reads b from: for the quad at c,
+//   bz[c + 0] = zeta * b[c + 1]    bz[c + 1] = b[c + 0] + b[c + 1]
+//   bz[c + 2] = -zeta * b[c + 3]   bz[c + 3] = b[c + 2] + b[c + 3]
+// Computed once for an operand reused across many products (s_hat in A * s).
+void poly_basemul_precompute(poly_t* bz, const poly_t* b) {
+#pragma HLS INLINE off
+    POLY_BANKED(bz->coeffs)
+    POLY_BANKED(b->coeffs)
+    TWIDDLE_BANKED(basemul_zeta_rom)
+    TWIDDLE_BANKED(basemul_zeta_neg_rom)
 
-        r->coeffs[4 * i + 0] = r0;
-        r->coeffs[4 * i + 1] = r1;
-        r->coeffs[4 * i + 2] = r2;
-        r->coeffs[4 * i + 3] = r3;
+    for (int it = 0; it < BASEMUL_LANE_ITERS; it++) {
+#pragma HLS PIPELINE II=1
+        CT_TRIP();
+        for (int u = 0; u < BASEMUL_LANES; u++) {
+#pragma HLS UNROLL
+            int c = 4 * (it * BASEMUL_LANES + u);
+            bz->coeffs[c + 0] = montgomery_reduce24((coeff_prod_t)basemul_zeta_rom.v[u][it] * b->coeffs[c + 1]);
+            bz->coeffs[c + 1] = b->coeffs[c + 0] + b->coeffs[c + 1];
+            bz->coeffs[c + 2] = montgomery_reduce24((coeff_prod_t)basemul_zeta_neg_rom.v[u][it] * b->coeffs[c + 3]);
+            bz->coeffs[c + 3] = b->coeffs[c + 2] + b->coeffs[c + 3];
+        }
     }
 }
 
+void poly_basemul_montgomery(poly_t *r, const poly_t *a, const poly_t *b) {
+    POLY_BANKED(r->coeffs)
+    POLY_BANKED(a->coeffs)
+    POLY_BANKED(b->coeffs)
+    TWIDDLE_BANKED(basemul_zeta_rom)
+    TWIDDLE_BANKED(basemul_zeta_neg_rom)
+
+    // BASEMUL_LANES coefficient quads per iteration, one coefficient per bank.
+    // b is used once here, so its zeta terms are formed on the fly.
+    for (int it = 0; it < BASEMUL_LANE_ITERS; it++) {
+#pragma HLS PIPELINE II=1
+        for (int u = 0; u < BASEMUL_LANES; u++) {
+#pragma HLS UNROLL
+            int c = 4 * (it * BASEMUL_LANES + u);
+            coeff_t b0 = b->coeffs[c + 0];
+            coeff_t b1 = b->coeffs[c + 1];
+            coeff_t b2 = b->coeffs[c + 2];
+            coeff_t b3 = b->coeffs[c + 3];
+            coeff_t zb1 = montgomery_reduce24((coeff_prod_t)basemul_zeta_rom.v[u][it] * b1);
+            coeff_t zb3 = montgomery_reduce24((coeff_prod_t)basemul_zeta_neg_rom.v[u][it] * b3);
+
+            coeff_acc_t r0, r1, r2, r3;
+            basemul_pair_lazy(r0, r1, a->coeffs[c + 0], a->coeffs[c + 1], b0, b1, zb1, b0 + b1);
+            basemul_pair_lazy(r2, r3, a->coeffs[c + 2], a->coeffs[c + 3], b2, b3, zb3, b2 + b3);
+
+            r->coeffs[c + 0] = barrett_reduce_acc(r0);
+            r->coeffs[c + 1] = barrett_reduce_acc(r1);
+            r->coeffs[c + 2] = barrett_reduce_acc(r2);
+            r->coeffs[c + 3] = barrett_reduce_acc(r3);
+        }
+    }
+}
 
+// Accumulate a * b for the coefficient quad at c, bz = poly_basemul_precompute(b)
+void poly_basemul_acc(coeff_acc_t acc[4], const poly_t* a, const poly_t* b, const poly_t* bz, int c) {
+#pragma HLS INLINE
+    POLY_BANKED(a->coeffs)
+    POLY_BANKED(b->coeffs)
+    POLY_BANKED(bz->coeffs)
+
+    coeff_acc_t r0, r1, r2, r3;
+    basemul_pair_lazy(r0, r1, a->coeffs[c + 0], a->coeffs[c + 1], b->coeffs[c + 0], b->coeffs[c + 1],
+                      bz->coeffs[c + 0], bz->coeffs[c + 1]);
+    basemul_pair_lazy(r2, r3, a->coeffs[c + 2], a->coeffs[c + 3], b->coeffs[c + 2], b->coeffs[c + 3],
+                      bz->coeffs[c + 2], bz->coeffs[c + 3]);
+
+    acc[0] += r0;
+    acc[1] += r1;
+    acc[2] += r2;
+    acc[3] += r3;
+}
 
-// Polynomial addition
+// Polynomial addition, coefficients in [0, q) in and out
 void poly_add(poly_t* r, const poly_t* a, const poly_t* b) {
 #pragma HLS INLINE 
-#pragma HLS ARRAY_PARTITION variable=r->coeffs complete
-#pragma HLS ARRAY_PARTITION variable=a->coeffs complete
-#pragma HLS ARRAY_PARTITION variable=b->coeffs complete
+    POLY_BANKED(r->coeffs)
+    POLY_BANKED(a->coeffs)
+    POLY_BANKED(b->coeffs)
 
-    for (int i = 0; i < MLKEM_N; i++) {        
-//#pragma HLS PIPELINE 
+    for (int i = 0; i < MLKEM_N; i += POLY_BANKS) {
+#pragma HLS PIPELINE II=1
+        for (int u = 0; u < POLY_BANKS; u++) {
 #pragma HLS UNROLL
-        r->coeffs[i] = barrett_reduce(a->coeffs[i] + b->coeffs[i]);
+            r->coeffs[i + u] = bounded_reduce(coeff_q_t(a->coeffs[i + u]) + coeff_q_t(b->coeffs[i + u])).v;
+        }
     }
 }
 
-// Polynomial subtraction
+// Polynomial subtraction, coefficients in [0, q) in and out
 void poly_sub(poly_t* r, const poly_t* a, const poly_t* b) {
 #pragma HLS INLINE off
-#pragma HLS ARRAY_PARTITION variable=r->coeffs complete
-#pragma HLS ARRAY_PARTITION variable=a->coeffs complete
-#pragma HLS ARRAY_PARTITION variable=b->coeffs complete
-
-    for (int i = 0; i < MLKEM_N; i++) {
+    POLY_BANKED(r->coeffs)
+    POLY_BANKED(a->coeffs)
+    POLY_BANKED(b->coeffs)
 
+    for (int i = 0; i < MLKEM_N; i += POLY_BANKS) {
 #pragma HLS PIPELINE II=1
-        r->coeffs[i] = a->coeffs[i] - b->coeffs[i] + MLKEM_Q;
+        for (int u = 0; u < POLY_BANKS; u++) {
+#pragma HLS UNROLL
+            r->coeffs[i + u] = bounded_reduce(coeff_q_t(a->coeffs[i + u]) - coeff_q_t(b->coeffs[i + u])).v;
+        }
     }
 }
 
 // Reduce polynomial coefficients modulo q
 void poly_reduce(poly_t* r) {
 #pragma HLS INLINE off
-#pragma HLS ARRAY_PARTITION variable=r->coeffs complete
+    POLY_BANKED(r->coeffs)
 
-    for (int i = 0; i < MLKEM_N; i++) {
+    for (int i = 0; i < MLKEM_N; i += POLY_BANKS) {
 #pragma HLS PIPELINE II=1
-        r->coeffs[i] = barrett_reduce(r->coeffs[i]);
+        for (int u = 0; u < POLY_BANKS; u++) {
+#pragma HLS UNROLL
+            r->coeffs[i + u] = barrett_reduce(r->coeffs[i + u]);
+        }
     }
 }
 
@@ -154,12 +288,13 @@ void poly_reduce(poly_t* r) {
 
 void poly_cbd_eta1(poly_t* r, const byte_t* buf) {
 #pragma HLS INLINE off
-#pragma HLS ARRAY_PARTITION variable=r->coeffs complete
-#pragma HLS ARRAY_PARTITION variable=buf complete
+    POLY_BANKED(r->coeffs)
+    BYTES_BANKED(buf)
 //print_hex(buf, 64 * MLKEM_ETA1 , "");
 
     for (int i = 0; i < MLKEM_N / 4; i++) {
 #pragma HLS PIPELINE II=1
+        CT_TRIP();
         // Combine 3 bytes into 24 bits
         uint32_t t = buf[3*i];
         t |= ((uint32_t)buf[3*i + 1]) << 8;
@@ -174,7 +309,8 @@ void poly_cbd_eta1(poly_t* r, const byte_t* buf) {
             // Count b = number of 1s in next 3 bits
             uint32_t b = (d >> 3 & 0x1) + (d >> 4 & 0x1) + (d >> 5 & 0x1);
 
-            r->coeffs[4*i + j] = (coeff_t)(a - b + MLKEM_Q); // mod wraparound-safe
+            // a - b + q lies in [q - 3, q + 3]: one csubq makes it canonical
+            r->coeffs[4*i + j] = bounded_reduce(bounded_coeff<3>(a) - bounded_coeff<3>(b)).v;
 
             t >>= 6; // move to next 6 bits
         }
@@ -184,30 +320,33 @@ void poly_cbd_eta1(poly_t* r, const byte_t* buf) {
 
 void poly_cbd_eta2(poly_t* r, const byte_t* buf) {
 #pragma HLS INLINE off
-#pragma HLS ARRAY_PARTITION variable=r->coeffs complete
-#pragma HLS ARRAY_PARTITION variable=buf complete
+    POLY_BANKED(r->coeffs)
+    BYTES_BANKED(buf)
 
     for (int i = 0; i < MLKEM_N; i++) {
 #pragma HLS PIPELINE II=1
+        CT_TRIP();
         uint32_t t = 0;
-        int byte_pos = i / 4;  // Each coefficient uses 4 bits from eta=2
-        int bit_pos = (i % 4) * 2;
-        
+        int byte_pos = i / 2;  // Each coefficient uses 4 bits from eta=2
+        int bit_pos = (i % 2) * 4;
+
         // Extract 4 bits for CBD(eta=2)
         t = (buf[byte_pos] >> bit_pos) & 0x0F;
-        
-        // Compute a - b where a and b are 2-bit values
-        uint32_t a = (t & 0x03) + ((t >> 2) & 0x03);
-        uint32_t b = ((t >> 1) & 0x01) + ((t >> 3) & 0x01);
-        r->coeffs[i] = (coeff_t)(a - b + MLKEM_Q);
+
+        // a and b count the ones in the low and high 2 bits
+        uint32_t a = (t & 0x01) + ((t >> 1) & 0x01);
+        uint32_t b = ((t >> 2) & 0x01) + ((t >> 3) & 0x01);
+
+        // a - b + q lies in [q - 2, q + 2]: one csubq makes it canonical
+        r->coeffs[i] = bounded_reduce(bounded_coeff<2>(a) - bounded_coeff<2>(b)).v;
     }
 }
 
 // Serialize polynomial to bytes
 void poly_tobytes(byte_t* r, const poly_t* a) {
 #pragma HLS INLINE off
-#pragma HLS ARRAY_PARTITION variable=r complete
-#pragma HLS ARRAY_PARTITION variable=a->coeffs complete
+#pragma HLS ARRAY_PARTITION variable=r cyclic factor=3
+    POLY_BANKED(a->coeffs)
 
     for (int i = 0; i < MLKEM_N; i += 2) {
 #pragma HLS PIPELINE II=1
@@ -223,8 +362,8 @@ void poly_tobytes(byte_t* r, const poly_t* a) {
 // Deserialize polynomial from bytes
 void poly_frombytes(poly_t* r, const byte_t* a) {
 #pragma HLS INLINE off
-#pragma HLS ARRAY_PARTITION variable=r->coeffs complete
-#pragma HLS ARRAY_PARTITION variable=a complete
+    POLY_BANKED(r->coeffs)
+#pragma HLS ARRAY_PARTITION variable=a cyclic factor=3
 
 
 
@@ -235,10 +374,191 @@ void poly_frombytes(poly_t* r, const byte_t* a) {
     }
 }
 
-// Uniform sampling from XOF
-void poly_uniform(poly_t* r, const byte_t* seed, byte_t nonce) {
+// Serialize polynomial to 64-bit beats: 16 coefficients are packed into two
+// 96-bit words and emitted as 3 aligned beats per cycle
+void poly_tobeats(beat_t r[MLKEM_POLYBEATS], const poly_t* a) {
+#pragma HLS INLINE off
+#pragma HLS ARRAY_PARTITION variable=r cyclic factor=3
+    POLY_BANKED(a->coeffs)
+
+    for (int i = 0; i < MLKEM_N / 16; i++) {
+#pragma HLS PIPELINE II=1
+        word96_t lo = 0, hi = 0;
+        for (int j = 0; j < 8; j++) {
+#pragma HLS UNROLL
+            lo |= (word96_t)csubq(a->coeffs[16 * i + j]) << (12 * j);
+            hi |= (word96_t)csubq(a->coeffs[16 * i + 8 + j]) << (12 * j);
+        }
+        r[3 * i] = (beat_t)lo;
+        r[3 * i + 1] = (beat_t)(lo >> 64) | ((beat_t)hi << 32);
+        r[3 * i + 2] = (beat_t)(hi >> 32);
+    }
+}
+
+// Deserialize polynomial from 64-bit beats: 3 beats -> 16 coefficients per cycle
+void poly_frombeats(poly_t* r, const beat_t a[MLKEM_POLYBEATS]) {
+#pragma HLS INLINE off
+    POLY_BANKED(r->coeffs)
+#pragma HLS ARRAY_PARTITION variable=a cyclic factor=3
+
+    for (int i = 0; i < MLKEM_N / 16; i++) {
+#pragma HLS PIPELINE II=1
+        beat_t b0 = a[3 * i], b1 = a[3 * i + 1], b2 = a[3 * i + 2];
+        word96_t lo = (word96_t)b0 | ((word96_t)(b1 & 0xFFFFFFFF) << 64);
+        word96_t hi = (word96_t)(b1 >> 32) | ((word96_t)b2 << 32);
+        for (int j = 0; j < 8; j++) {
+#pragma HLS UNROLL
+            r->coeffs[16 * i + j] = (coeff_t)(lo >> (12 * j)) & 0xFFF;
+            r->coeffs[16 * i + 8 + j] = (coeff_t)(hi >> (12 * j)) & 0xFFF;
+        }
+    }
+}
+
+// Pack bytes into little-endian 64-bit beats
+void bytes_tobeats(beat_t* r, const byte_t* a, int nbeats) {
+#pragma HLS INLINE off
+    for (int i = 0; i < nbeats; i++) {
+#pragma HLS LOOP_TRIPCOUNT min=4 max=100
+#pragma HLS PIPELINE II=1
+        beat_t w = 0;
+        for (int j = 0; j < 8; j++) {
+#pragma HLS UNROLL
+            w |= (beat_t)a[8 * i + j] << (8 * j);
+        }
+        r[i] = w;
+    }
+}
+
+// Unpack little-endian 64-bit beats into bytes
+void beats_tobytes(byte_t* r, const beat_t* a, int nbeats) {
+#pragma HLS INLINE off
+    for (int i = 0; i < nbeats; i++) {
+#pragma HLS LOOP_TRIPCOUNT min=4 max=100
+#pragma HLS PIPELINE II=1
+        beat_t w = a[i];
+        for (int j = 0; j < 8; j++) {
+#pragma HLS UNROLL
+            r[8 * i + j] = (byte_t)(w >> (8 * j));
+        }
+    }
+}
+
+// Compression: round(2^d * x / q) mod 2^d using a fixed-point reciprocal of q
+// (2^28/q for d=4, 2^32/q for d=10) so no divider is needed per coefficient.
+// Valid for x in [0, q-1]; callers apply csubq first.
+ap_uint<4> compress_d4(coeff_t x) {
+#pragma HLS INLINE
+    ap_uint<16> t = ((ap_uint<16>)x << 4) + 1665;
+    ap_uint<33> p = (ap_uint<33>)t * 80635;
+    return (ap_uint<4>)(p >> 28);
+}
+
+ap_uint<10> compress_d10(coeff_t x) {
+#pragma HLS INLINE
+    ap_uint<22> t = ((ap_uint<22>)x << 10) + 1665;
+    ap_uint<43> p = (ap_uint<43>)t * 1290167;
+    return (ap_uint<10>)(p >> 32);
+}
+
+// Decompression: round(q * y / 2^d) as (q * y + 2^(d-1)) >> d
+coeff_t decompress_d4(ap_uint<4> y) {
+#pragma HLS INLINE
+    ap_uint<16> t = (ap_uint<16>)y * MLKEM_Q + 8;
+    return (coeff_t)(t >> 4);
+}
+
+coeff_t decompress_d10(ap_uint<10> y) {
+#pragma HLS INLINE
+    ap_uint<22> t = (ap_uint<22>)y * MLKEM_Q + 512;
+    return (coeff_t)(t >> 10);
+}
+
+// Compress polynomial with dv = 4: 8 coefficients -> 4 bytes per cycle
+void poly_compress(byte_t r[MLKEM_POLYCOMPRESSEDBYTES_DV], const poly_t* a) {
+#pragma HLS INLINE off
+#pragma HLS ARRAY_PARTITION variable=r cyclic factor=4
+    POLY_BANKED(a->coeffs)
+
+    for (int i = 0; i < MLKEM_N / 8; i++) {
+#pragma HLS PIPELINE II=1
+        ap_uint<32> packed = 0;
+        for (int j = 0; j < 8; j++) {
+#pragma HLS UNROLL
+            packed |= (ap_uint<32>)compress_d4(csubq(a->coeffs[8 * i + j])) << (4 * j);
+        }
+        for (int j = 0; j < 4; j++) {
+#pragma HLS UNROLL
+            r[4 * i + j] = (byte_t)(packed >> (8 * j));
+        }
+    }
+}
+
+// Decompress polynomial with dv = 4: 4 bytes -> 8 coefficients per cycle
+void poly_decompress(poly_t* r, const byte_t a[MLKEM_POLYCOMPRESSEDBYTES_DV]) {
+#pragma HLS INLINE off
+    POLY_BANKED(r->coeffs)
+#pragma HLS ARRAY_PARTITION variable=a cyclic factor=4
+
+    for (int i = 0; i < MLKEM_N / 8; i++) {
+#pragma HLS PIPELINE II=1
+        ap_uint<32> packed = 0;
+        for (int j = 0; j < 4; j++) {
+#pragma HLS UNROLL
+            packed |= (ap_uint<32>)a[4 * i + j] << (8 * j);
+        }
+        for (int j = 0; j < 8; j++) {
+#pragma HLS UNROLL
+            r->coeffs[8 * i + j] = decompress_d4((ap_uint<4>)(packed >> (4 * j)));
+        }
+    }
+}
+
+// Compress polynomial with du = 10: 4 coefficients -> 5 bytes per cycle
+void poly_compress_du(byte_t r[MLKEM_POLYCOMPRESSEDBYTES_DU], const poly_t* a) {
+#pragma HLS INLINE off
+#pragma HLS ARRAY_PARTITION variable=r cyclic factor=5
+    POLY_BANKED(a->coeffs)
+
+    for (int i = 0; i < MLKEM_N / 4; i++) {
+#pragma HLS PIPELINE II=1
+        ap_uint<40> packed = 0;
+        for (int j = 0; j < 4; j++) {
+#pragma HLS UNROLL
+            packed |= (ap_uint<40>)compress_d10(csubq(a->coeffs[4 * i + j])) << (10 * j);
+        }
+        for (int j = 0; j < 5; j++) {
+#pragma HLS UNROLL
+            r[5 * i + j] = (byte_t)(packed >> (8 * j));
+        }
+    }
+}
+
+// Decompress polynomial with du = 10: 5 bytes -> 4 coefficients per cycle
+void poly_decompress_du(poly_t* r, const byte_t a[MLKEM_POLYCOMPRESSEDBYTES_DU]) {
 #pragma HLS INLINE off
-#pragma HLS ARRAY_PARTITION variable=r->coeffs complete
+    POLY_BANKED(r->coeffs)
+#pragma HLS ARRAY_PARTITION variable=a cyclic factor=5
+
+    for (int i = 0; i < MLKEM_N / 4; i++) {
+#pragma HLS PIPELINE II=1
+        ap_uint<40> packed = 0;
+        for (int j = 0; j < 5; j++) {
+#pragma HLS UNROLL
+            packed |= (ap_uint<40>)a[5 * i + j] << (8 * j);
+        }
+        for (int j = 0; j < 4; j++) {
+#pragma HLS UNROLL
+            r->coeffs[4 * i + j] = decompress_d10((ap_uint<10>)(packed >> (10 * j)));
+        }
+    }
+}
+
+// Uniform sampling from XOF: entry (i, j) of A, nonce = i * K + j, is
+// XOF(rho || j || i); with transposed set the two bytes swap and the same
+// nonce gives entry (i, j) of A^T
+void poly_uniform(poly_t* r, const byte_t* seed, byte_t nonce, bool transposed) {
+#pragma HLS INLINE off
+    POLY_BANKED(r->coeffs)
 
     byte_t input[34];
 #pragma HLS ARRAY_PARTITION variable=input complete
@@ -248,29 +568,38 @@ void poly_uniform(poly_t* r, const byte_t* seed, byte_t nonce) {
 #pragma HLS UNROLL
         input[i] = seed[i];
     }
-    input[33] = (nonce == 2) | (nonce == 3);
-    input[32] = nonce % 2;
+    byte_t row = nonce / MLKEM_K;
+    byte_t col = nonce % MLKEM_K;
+    input[32] = transposed ? row : col;
+    input[33] = transposed ? col : row;
    // printf("\n%x\n",nonce);
     //print_poly(r[0]);
-    // Generate random bytes using SHAKE128
-    byte_t buf[REJ_UNIFORM_BUFLEN];
-    
-#pragma HLS ARRAY_PARTITION variable=buf complete
-
-shake128(input, 34, buf, REJ_UNIFORM_BUFLEN);
+    lane_t state[25];
+#pragma HLS ARRAY_PARTITION variable=state complete
+    shake128_absorb(state, input, 34);
 
-    // Rejection sampling
+    // Rejection sampling one SHAKE128 block at a time until all MLKEM_N
+    // coefficients are found, however many blocks that takes (FIPS 203).
+    // Known-latency mode scans REJ_UNIFORM_FIXED_BLOCKS blocks in full.
     int ctr = 0;
-    for (int i = 0; i < REJ_UNIFORM_BUFLEN && ctr < MLKEM_N; i += 3) {
+    for (int blk = 0; MLKEM_FIXED_LATENCY ? blk < REJ_UNIFORM_FIXED_BLOCKS : ctr < MLKEM_N; blk++) {
+#pragma HLS LOOP_TRIPCOUNT min=3 max=5
+        byte_t buf[SHAKE128_RATE];
+        BYTES_BANKED(buf)
+        shake128_squeeze_block(state, blk == 0, buf);
+
+        for (int i = 0; i < SHAKE128_RATE && (MLKEM_FIXED_LATENCY || ctr < MLKEM_N); i += 3) {
 #pragma HLS PIPELINE II=1
-        coeff_t val1 = ((coeff_t)buf[i] | ((coeff_t)buf[i + 1] << 8)) & 0xFFF;
-        coeff_t val2 = ((coeff_t)buf[i + 1] >> 4 | ((coeff_t)buf[i + 2] << 4)) & 0xFFF;
-        
-        if (val1 < MLKEM_Q && ctr < MLKEM_N) {
-            r->coeffs[ctr++] = val1;
-        }
-        if (val2 < MLKEM_Q && ctr < MLKEM_N) {
-            r->coeffs[ctr++] = val2;
+            CT_TRIP();
+            coeff_t val1 = ((coeff_t)buf[i] | ((coeff_t)buf[i + 1] << 8)) & 0xFFF;
+            coeff_t val2 = ((coeff_t)buf[i + 1] >> 4 | ((coeff_t)buf[i + 2] << 4)) & 0xFFF;
+
+            if (val1 < MLKEM_Q && ctr < MLKEM_N) {
+                r->coeffs[ctr++] = val1;
+            }
+            if (val2 < MLKEM_Q && ctr < MLKEM_N) {
+                r->coeffs[ctr++] = val2;
+            }
         }
     }
 }
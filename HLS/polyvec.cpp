@@ -2,13 +2,20 @@
 // Matrix type for A matrix
 
 
-// Vector NTT forward transform
+// Vector NTT forward transform. With NTT_STREAMING the K polynomials go
+// back to back through the streaming engine, from a copy since its input
+// and output must be distinct.
 void polyvec_ntt(polyvec_t* r) {
 #pragma HLS INLINE off
+#if NTT_STREAMING
+    polyvec_t a = *r;
+    ntt_forward_polys(r->vec, a.vec, MLKEM_K);
+#else
     for (int i = 0; i < MLKEM_K; i++) {
 #pragma HLS UNROLL
         ntt_forward(&r->vec[i]);
     }
+#endif
 }
 
 // Vector NTT i
@@ -40,29 +47,57 @@ void polyvec_reduce(polyvec_t* r) {
     }
 }
 
-// Point-wise multiplication and accumulation
-void polyvec_pointwise_acc_montgomery(poly_t* r, const polyvec_t* a, const polyvec_t* b) {
+// Basemul operand terms of every polynomial of b (see poly_basemul_precompute)
+void polyvec_basemul_precompute(polyvec_t* bz, const polyvec_t* b) {
 #pragma HLS INLINE off
-    poly_t temp;
-#pragma HLS ARRAY_PARTITION variable=temp.coeffs complete
-    
-    // Initialize result with first multiplication
-    poly_basemul_montgomery(r, &a->vec[0], &b->vec[0]);
-    
-    // Accumulate remaining multiplications
-    for (int i = 1; i < MLKEM_K; i++) {
+    for (int i = 0; i < MLKEM_K; i++) {
 #pragma HLS UNROLL
-        poly_basemul_montgomery(&temp, &a->vec[i], &b->vec[i]);
-        poly_add(r, r, &temp);
+        poly_basemul_precompute(&bz->vec[i], &b->vec[i]);
     }
 }
 
-// Matrix-vector multiplication: r = A * s
+// Point-wise multiplication and accumulation, fused: for each coefficient
+// quad the K Karatsuba base multiplications are summed unreduced into
+// coeff_acc_t accumulators and reduced once, so there is no temporary
+// polynomial and no per-product poly_add pass. bz is
+// polyvec_basemul_precompute(b), which carries the zeta products.
+void polyvec_pointwise_acc_montgomery(poly_t* r, const polyvec_t* a, const polyvec_t* b, const polyvec_t* bz) {
+#pragma HLS INLINE off
+    POLY_BANKED(r->coeffs)
+
+    // BASEMUL_LANES coefficient quads per iteration: one coefficient per bank
+    for (int it = 0; it < BASEMUL_LANE_ITERS; it++) {
+#pragma HLS PIPELINE II=1
+        CT_TRIP();
+        for (int u = 0; u < BASEMUL_LANES; u++) {
+#pragma HLS UNROLL
+            int c = 4 * (it * BASEMUL_LANES + u);
+            coeff_acc_t acc[4] = {0, 0, 0, 0};
+#pragma HLS ARRAY_PARTITION variable=acc complete
+
+            for (int j = 0; j < MLKEM_K; j++) {
+#pragma HLS UNROLL
+                poly_basemul_acc(acc, &a->vec[j], &b->vec[j], &bz->vec[j], c);
+            }
+
+            for (int k = 0; k < 4; k++) {
+#pragma HLS UNROLL
+                r->coeffs[c + k] = barrett_reduce_acc(acc[k]);
+            }
+        }
+    }
+}
+
+// Matrix-vector multiplication: r = A * s. s is shared by every row, so
+// its zeta terms are computed once here rather than once per row.
 void matrix_vector_mul(polyvec_t* r, const matrix_t* A, const polyvec_t* s) {
 #pragma HLS INLINE off
+    polyvec_t s_pre;
+    polyvec_basemul_precompute(&s_pre, s);
+
     for (int i = 0; i < MLKEM_K; i++) {
 #pragma HLS UNROLL
-        polyvec_pointwise_acc_montgomery(&r->vec[i], &A->rows[i], s);
+        polyvec_pointwise_acc_montgomery(&r->vec[i], &A->rows[i], s, &s_pre);
     }
 }
 // Field arithmetic
@@ -103,14 +138,50 @@ void polyvec_frombytes(polyvec_t* r, const byte_t* a) {
     }
 }
 
-// Matrix generation from seed
-void matrix_expand(matrix_t* A, const byte_t* rho) {
+// Vector serialization to 64-bit beats
+void polyvec_tobeats(beat_t r[MLKEM_K * MLKEM_POLYBEATS], const polyvec_t* a) {
+#pragma HLS INLINE off
+    for (int i = 0; i < MLKEM_K; i++) {
+#pragma HLS UNROLL
+        poly_tobeats(r + i * MLKEM_POLYBEATS, &a->vec[i]);
+    }
+}
+
+// Vector deserialization from 64-bit beats
+void polyvec_frombeats(polyvec_t* r, const beat_t a[MLKEM_K * MLKEM_POLYBEATS]) {
+#pragma HLS INLINE off
+    for (int i = 0; i < MLKEM_K; i++) {
+#pragma HLS UNROLL
+        poly_frombeats(&r->vec[i], a + i * MLKEM_POLYBEATS);
+    }
+}
+
+// Vector compression (du = 10)
+void polyvec_compress(byte_t r[MLKEM_POLYVECCOMPRESSEDBYTES_DU], const polyvec_t* a) {
+#pragma HLS INLINE off
+    for (int i = 0; i < MLKEM_K; i++) {
+#pragma HLS UNROLL
+        poly_compress_du(r + i * MLKEM_POLYCOMPRESSEDBYTES_DU, &a->vec[i]);
+    }
+}
+
+// Vector decompression (du = 10)
+void polyvec_decompress(polyvec_t* r, const byte_t a[MLKEM_POLYVECCOMPRESSEDBYTES_DU]) {
+#pragma HLS INLINE off
+    for (int i = 0; i < MLKEM_K; i++) {
+#pragma HLS UNROLL
+        poly_decompress_du(&r->vec[i], a + i * MLKEM_POLYCOMPRESSEDBYTES_DU);
+    }
+}
+
+// Matrix generation from seed, as A or (transposed) directly as A^T
+void matrix_expand(matrix_t* A, const byte_t* rho, bool transposed) {
 #pragma HLS INLINE off
     for (int i = 0; i < MLKEM_K; i++) {
 #pragma HLS UNROLL
         for (int j = 0; j < MLKEM_K; j++) {
 #pragma HLS UNROLL
-            poly_uniform(&A->rows[i].vec[j], rho, (byte_t)(i * MLKEM_K + j));
+            poly_uniform(&A->rows[i].vec[j], rho, (byte_t)(i * MLKEM_K + j), transposed);
         }
     }
 }
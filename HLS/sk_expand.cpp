@@ -0,0 +1,53 @@
+#include "unified.h"
+
+// Seed-form secret key expansion.
+//
+// Two independent dataflow processes: sk_expand runs the keygen datapath on
+// (d, z) to rebuild the expanded sk (s_hat || pk || H(pk) || z), while
+// ct_unpack reads and decompresses the ciphertext. Neither waits for the
+// other, so the ciphertext is ready as soon as the (much longer) expansion
+// finishes.
+
+static void sk_expand(const beat_t sk_seed[MLKEM_SEEDSKBEATS], beat_t sk[MLKEM_SECRETKEYBEATS]) {
+#pragma HLS INLINE off
+    byte_t d[MLKEM_SYMBYTES], z[MLKEM_SYMBYTES];
+    beat_t pk[MLKEM_PUBLICKEYBEATS];
+
+    beats_tobytes(d, sk_seed, MLKEM_SYMBEATS);
+    beats_tobytes(z, sk_seed + MLKEM_SYMBEATS, MLKEM_SYMBEATS);
+
+    // pk is part of sk; the separate copy is not needed here
+    mlkem512_keygen(d, z, pk, sk);
+}
+
+static void ct_unpack(const beat_t ct[MLKEM_CIPHERTEXTBEATS], beat_t ct_polys[MLKEM_CTPOLYBEATS]) {
+#pragma HLS INLINE off
+    byte_t ct_bytes[MLKEM_CIPHERTEXTBYTES];
+    BYTES_BANKED(ct_bytes)
+    polyvec_t u;
+    poly_t v;
+
+    beats_tobytes(ct_bytes, ct, MLKEM_CIPHERTEXTBEATS);
+    polyvec_decompress(&u, ct_bytes);
+    poly_decompress(&v, ct_bytes + MLKEM_POLYVECCOMPRESSEDBYTES_DU);
+
+    polyvec_tobeats(ct_polys, &u);
+    poly_tobeats(ct_polys + MLKEM_K * MLKEM_POLYBEATS, &v);
+}
+
+void mlkem512_sk_expand_top(const beat_t sk_seed[MLKEM_SEEDSKBEATS], const beat_t ct[MLKEM_CIPHERTEXTBEATS],
+                            beat_t sk[MLKEM_SECRETKEYBEATS], beat_t ct_polys[MLKEM_CTPOLYBEATS]) {
+#pragma HLS INTERFACE m_axi port=sk_seed offset=slave bundle=gmem0 depth=8
+#pragma HLS INTERFACE m_axi port=ct offset=slave bundle=gmem1 depth=96
+#pragma HLS INTERFACE m_axi port=sk offset=slave bundle=gmem2 depth=204
+#pragma HLS INTERFACE m_axi port=ct_polys offset=slave bundle=gmem3 depth=144
+#pragma HLS INTERFACE s_axilite port=sk_seed bundle=control
+#pragma HLS INTERFACE s_axilite port=ct bundle=control
+#pragma HLS INTERFACE s_axilite port=sk bundle=control
+#pragma HLS INTERFACE s_axilite port=ct_polys bundle=control
+#pragma HLS INTERFACE s_axilite port=return bundle=control
+#pragma HLS DATAFLOW
+
+    sk_expand(sk_seed, sk);
+    ct_unpack(ct, ct_polys);
+}
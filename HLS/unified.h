@@ -2,10 +2,12 @@
 #define MLKEM_UNIFIED_H
 
 #include "ap_int.h"
+#include "hls_stream.h"
 #include <stdint.h>
 #include <cstring>
 #include <iostream>
 #include <iomanip>
+#include <type_traits>
 // ============================================================================
 // ML-KEM-512 PARAMETERS AND CONSTANTS
 // ============================================================================
@@ -28,35 +30,88 @@ const int MLKEM_POLYCOMPRESSEDBYTES_DV = 128;  // Compressed polynomial size for
 // Basic types
 typedef ap_uint<8> byte_t;
 typedef ap_uint<16> coeff_t;       // Coefficient type (can hold values up to q-1)
+typedef ap_uint<13> coeff_sum_t;   // Sum/difference of two reduced coefficients (< 2q)
+typedef ap_uint<24> coeff_prod_t;  // Product of two coefficients below 2^12
+typedef ap_uint<27> coeff_acc_t;   // Lazy sum of 2*K = 4 unreduced products, and the Karatsuba term (a0+a1)(b0+b1): < 4q^2 < 2^26
 typedef ap_uint<64> lane_t;
     // For Keccak permutation
+typedef ap_uint<64> beat_t;        // One 64-bit m_axi data beat (8 bytes, little-endian)
+typedef ap_uint<96> word96_t;      // 8 packed 12-bit coefficients
 
 // Public key size: k * polybytes + 32
 const int MLKEM_PUBLICKEYBYTES = MLKEM_K * MLKEM_POLYBYTES + MLKEM_SYMBYTES;  // 800 bytes
 // Private key size: k * polybytes + publickey + 32 + 32
 const int MLKEM_SECRETKEYBYTES = MLKEM_K * MLKEM_POLYBYTES + MLKEM_PUBLICKEYBYTES + MLKEM_SYMBYTES + MLKEM_SYMBYTES;  // 1632 bytes
+// Compressed vector size: k * polycompressedbytes_du
+const int MLKEM_POLYVECCOMPRESSEDBYTES_DU = MLKEM_K * MLKEM_POLYCOMPRESSEDBYTES_DU;  // 640 bytes
+
+// Sizes in 64-bit m_axi beats
+const int MLKEM_POLYBEATS = MLKEM_POLYBYTES / 8;              // 48 beats
+const int MLKEM_SYMBEATS = MLKEM_SYMBYTES / 8;                // 4 beats
+const int MLKEM_PUBLICKEYBEATS = MLKEM_PUBLICKEYBYTES / 8;    // 100 beats
+const int MLKEM_SECRETKEYBEATS = MLKEM_SECRETKEYBYTES / 8;    // 204 beats
 
 // Constants for SHAKE128
 const int SHAKE128_RATE = 168;       // 1344 bits / 8 = 168 bytes
 const int SHAKE128_CAPACITY = 32;    // 256 bits / 8 = 32 bytes
 const int SHAKE256_RATE = 136; // 1088 bits / 8 = 136 bytes
 const int SHAKE256_CAPACITY = 64;
+const int SHA3_256_RATE = 136;       // 1088 bits / 8 = 136 bytes
+const int SHA3_512_RATE = 72;        // 576 bits / 8 = 72 bytes
+const int SHA3_256_RATE_LANES = SHA3_256_RATE / 8;
+// SHA3-256 blocks for H(pk): full blocks plus the one carrying the tail and padding
+const int PK_HASH_BLOCKS = MLKEM_PUBLICKEYBEATS / SHA3_256_RATE_LANES + 1;
 // Rejection sampling bounds
 const int REJ_UNIFORM_BUFLEN = 504;  // Buffer length for uniform sampling
 const int REJ_UNIFORM_ETA_BUFLEN = 256;  // Buffer length for CBD sampling
 
 // NTT constants
 const int NTT_ZETAS_SIZE = 128;
-const coeff_t ntt_zetas[NTT_ZETAS_SIZE] = {1, 1729, 2580, 3289, 2642, 630, 1897, 848, 1062, 1919, 193, 797, 2786, 3260, 569, 1746, 296, 2447, 1339, 
-1476, 3046, 56, 2240, 1333, 1426, 2094, 535, 2882, 2393, 2879, 1974, 821, 289, 331, 3253, 1756, 1197, 2304, 2277, 2055, 650, 1977, 2513, 632, 2865,
- 33, 1320, 1915, 2319, 1435, 807, 452, 1438, 2868, 1534, 2402, 2647, 2617, 1481, 648, 2474, 3110, 1227, 910, 17, 2761, 583, 2649, 1637, 723, 2288, 
- 1100, 1409, 2662, 3281, 233, 756, 2156, 3015, 3050, 1703, 1651, 2789, 1789, 1847, 952, 1461, 2687, 939, 2308, 2437, 2388, 733, 2337, 268, 641, 1584,
-  2298, 2037, 3220, 375, 2549, 2090, 1645, 1063, 319, 2773, 757, 2099, 561, 2466, 2594, 2804, 1092, 403, 1026, 1143, 2150, 2775, 886, 1722, 1212, 1874,
-   1029, 2110, 2935, 885, 2154};
-
+const int NTT_LAYERS = 7;              // Layers of the incomplete NTT (len 128 .. 2)
+
+
+// Keccak rounds are issued every KECCAK_ROUND_II cycles. 1 gives one round
+// per cycle; 2 lets the scheduler register the theta output and split the
+// round for clock targets of 200 MHz and above.
+#ifndef KECCAK_ROUND_II
+#define KECCAK_ROUND_II 1
+#endif
+
+// Independent Keccak states interleaved through the batched hashing core
+#ifndef KECCAK_STATES
+#define KECCAK_STATES 4
+#endif
+
+// Known-latency mode: with MLKEM_FIXED_LATENCY=1 no loop in keygen has a
+// data-dependent trip count, so every call takes the same number of cycles.
+// The stages that touch secrets (G, PRF, CBD, NTT, basemul, packing) are
+// fixed-length in both modes; this mode also fixes matrix expansion, which
+// otherwise squeezes SHAKE128 blocks only until 256 coefficients are found.
+#ifndef MLKEM_FIXED_LATENCY
+#define MLKEM_FIXED_LATENCY 0
+#endif
+// SHAKE128 blocks per matrix entry in known-latency mode: 560 candidates
+// for 256 coefficients, short with probability below 2^-260
+const int REJ_UNIFORM_FIXED_BLOCKS = 5;
+
+// Trip counters for the latency checks in main_test (C simulation only):
+// CT_STAGE marks the keygen stage being run and CT_TRIP counts one pipeline
+// iteration or Keccak round against it. They are per thread: the host
+// driver's mock device runs the C model from several threads at once.
+enum ct_stage_t { CT_G, CT_MATRIX, CT_PRF, CT_CBD, CT_NTT, CT_BASEMUL, CT_PACK, CT_STAGES };
+#ifndef __SYNTHESIS__
+extern thread_local uint64_t ct_trips[CT_STAGES];
+extern thread_local int ct_stage;
+#define CT_STAGE(s) (ct_stage = (s))
+#define CT_TRIP() (ct_trips[ct_stage]++)
+#else
+#define CT_STAGE(s)
+#define CT_TRIP()
+#endif
 
 // Montgomery reduction constants
 const uint16_t QINV = 62209;  // q^(-1) mod 2^16
+const uint16_t QINV_NEG = 3327; // -q^(-1) mod 2^16
 const uint16_t MONT = 2285;   // 2^16 mod q
 
 // ============================================================================
@@ -64,6 +119,150 @@ const uint16_t MONT = 2285;   // 2^16 mod q
 // ============================================================================
 
 void print_hex(const byte_t* data, int len, const std::string& label) ;
+
+// Coefficient storage layout: every poly_t (and so every polyvec_t/matrix_t)
+// is split cyclically over POLY_BANKS memory banks, coefficient i in bank
+// i % POLY_BANKS. Each bank is a dual-port RAM, so a pipelined loop gets
+// 2 * POLY_BANKS coefficient accesses per cycle without flattening the
+// polynomial into registers. Use POLY_BANKED(x->coeffs) on every coefficient
+// argument so callers and callees agree on the layout, and POLY_STORAGE on
+// locally declared polynomials to pin the banks to BRAM. POLY_BANKS also
+// sets the NTT butterflies and basemul quads per iteration (4, 8 or 16).
+#ifndef POLY_BANKS
+#define POLY_BANKS 8
+#endif
+static_assert(POLY_BANKS == 4 || POLY_BANKS == 8 || POLY_BANKS == 16, "POLY_BANKS must be 4, 8 or 16");
+#define HLS_PRAGMA_SUB(x) _Pragma(#x)
+#define HLS_PRAGMA(x) HLS_PRAGMA_SUB(x)
+#define POLY_BANKED(var) \
+    HLS_PRAGMA(HLS ARRAY_PARTITION variable=var cyclic factor=POLY_BANKS)
+#define POLY_STORAGE(var) \
+    POLY_BANKED(var) \
+    HLS_PRAGMA(HLS BIND_STORAGE variable=var type=ram_t2p impl=bram)
+// Butterflies per NTT pipeline iteration: one coefficient pair per bank
+const int NTT_BUTTERFLIES = POLY_BANKS;
+
+// Twiddle ROMs, generated at compile time in Montgomery form (zeta * 2^16
+// mod q) so a single montgomery_reduce24 of the product gives zeta * x mod q.
+// Each table is laid out [lane][iteration]: lane u holds exactly the
+// twiddles that butterfly unit u reads, so with dim 1 partitioned every unit
+// has a private ROM and nothing is computed from a twiddle at run time.
+const int NTT_LANE_ITERS = MLKEM_N / 2 / NTT_BUTTERFLIES;  // Pipeline iterations per layer
+const int BASEMUL_LANES = POLY_BANKS / 4;                  // Coefficient quads per iteration
+const int BASEMUL_LANE_ITERS = MLKEM_N / 4 / BASEMUL_LANES;
+
+template <int LANES, int DEPTH>
+struct twiddle_rom_t {
+    uint16_t v[LANES][DEPTH];
+};
+
+// Flat compile-time table, indexed like the plain array it replaces
+template <typename T, int N>
+struct const_table_t {
+    T v[N];
+    constexpr const T& operator[](int i) const { return v[i]; }
+};
+
+// 17^e mod q, 17 being the primitive 256th root of unity
+constexpr int zeta_pow(int e) {
+    int r = 1;
+    for (int i = 0; i < e; i++)
+        r = r * 17 % MLKEM_Q;
+    return r;
+}
+
+// zeta_k = 17^brv7(k)
+constexpr int zeta_plain(int k) {
+    int rev = 0;
+    for (int i = 0; i < 7; i++)
+        rev |= ((k >> i) & 1) << (6 - i);
+    return zeta_pow(rev);
+}
+
+constexpr uint16_t to_mont(int x) {
+    return (uint16_t)(x * MONT % MLKEM_Q);
+}
+
+// zeta_0 .. zeta_127 in bit-reversed order, plain (mont = false) or
+// Montgomery form
+constexpr const_table_t<uint16_t, NTT_ZETAS_SIZE> make_zetas(bool mont) {
+    const_table_t<uint16_t, NTT_ZETAS_SIZE> r{};
+    for (int k = 0; k < NTT_ZETAS_SIZE; k++)
+        r.v[k] = mont ? to_mont(zeta_plain(k)) : (uint16_t)zeta_plain(k);
+    return r;
+}
+
+constexpr const_table_t<uint16_t, NTT_ZETAS_SIZE> ntt_zetas = make_zetas(false);
+constexpr const_table_t<uint16_t, NTT_ZETAS_SIZE> ntt_zetas_mont = make_zetas(true);
+
+// Forward (Cooley-Tukey) layer s, butterfly bi = it * NTT_BUTTERFLIES + u:
+// zeta_{2^s + bi / len}
+constexpr twiddle_rom_t<NTT_BUTTERFLIES, NTT_LAYERS * NTT_LANE_ITERS> make_ntt_fwd_rom() {
+    twiddle_rom_t<NTT_BUTTERFLIES, NTT_LAYERS * NTT_LANE_ITERS> r{};
+    for (int u = 0; u < NTT_BUTTERFLIES; u++)
+        for (int s = 0; s < NTT_LAYERS; s++)
+            for (int it = 0; it < NTT_LANE_ITERS; it++)
+                r.v[u][s * NTT_LANE_ITERS + it] =
+                    to_mont(zeta_plain((MLKEM_N / 2 + it * NTT_BUTTERFLIES + u) >> (7 - s)));
+    return r;
+}
+
+// Inverse (Gentleman-Sande) layer s, same butterfly numbering:
+// zeta_{2^(s+1) - 1 - bi / len}
+constexpr twiddle_rom_t<NTT_BUTTERFLIES, NTT_LAYERS * NTT_LANE_ITERS> make_ntt_inv_rom() {
+    twiddle_rom_t<NTT_BUTTERFLIES, NTT_LAYERS * NTT_LANE_ITERS> r{};
+    for (int u = 0; u < NTT_BUTTERFLIES; u++)
+        for (int s = 0; s < NTT_LAYERS; s++)
+            for (int it = 0; it < NTT_LANE_ITERS; it++)
+                r.v[u][s * NTT_LANE_ITERS + it] =
+                    to_mont(zeta_plain((2 << s) - 1 - ((it * NTT_BUTTERFLIES + u) >> (7 - s))));
+    return r;
+}
+
+// Base multiplication of quad q = it * BASEMUL_LANES + u: +zeta_{64+q} for
+// the first pair, -zeta_{64+q} for the second
+constexpr twiddle_rom_t<BASEMUL_LANES, BASEMUL_LANE_ITERS> make_basemul_rom(bool neg) {
+    twiddle_rom_t<BASEMUL_LANES, BASEMUL_LANE_ITERS> r{};
+    for (int u = 0; u < BASEMUL_LANES; u++)
+        for (int it = 0; it < BASEMUL_LANE_ITERS; it++) {
+            int z = zeta_plain(64 + it * BASEMUL_LANES + u);
+            r.v[u][it] = to_mont(neg ? MLKEM_Q - z : z);
+        }
+    return r;
+}
+
+constexpr twiddle_rom_t<NTT_BUTTERFLIES, NTT_LAYERS * NTT_LANE_ITERS> ntt_fwd_rom = make_ntt_fwd_rom();
+constexpr twiddle_rom_t<NTT_BUTTERFLIES, NTT_LAYERS * NTT_LANE_ITERS> ntt_inv_rom = make_ntt_inv_rom();
+constexpr twiddle_rom_t<BASEMUL_LANES, BASEMUL_LANE_ITERS> basemul_zeta_rom = make_basemul_rom(false);
+constexpr twiddle_rom_t<BASEMUL_LANES, BASEMUL_LANE_ITERS> basemul_zeta_neg_rom = make_basemul_rom(true);
+const uint16_t NTT_INV_SCALE_MONT = to_mont(3303);  // 128^(-1) mod q
+
+// Spot checks against the FIPS 203 tables
+static_assert(MONT == (1 << 16) % MLKEM_Q, "MONT must be 2^16 mod q");
+static_assert((QINV * MLKEM_Q) % (1 << 16) == 1, "QINV must be q^-1 mod 2^16");
+static_assert((QINV_NEG + QINV) % (1 << 16) == 0, "QINV_NEG must be -q^-1 mod 2^16");
+static_assert(3303 * 128 % MLKEM_Q == 1, "inverse NTT scale must be 128^-1 mod q");
+static_assert(zeta_pow(128) == MLKEM_Q - 1, "17 must be a primitive 256th root of unity");
+static_assert(ntt_zetas[0] == 1 && ntt_zetas[1] == 1729 && ntt_zetas[2] == 2580 &&
+              ntt_zetas[64] == 17 && ntt_zetas[127] == 2154, "ntt_zetas mismatch");
+static_assert(ntt_zetas_mont[1] == 1729 * MONT % MLKEM_Q, "ntt_zetas_mont mismatch");
+static_assert(ntt_fwd_rom.v[0][0] == ntt_zetas_mont[1] &&
+              ntt_fwd_rom.v[NTT_BUTTERFLIES - 1][NTT_LAYERS * NTT_LANE_ITERS - 1] == ntt_zetas_mont[127],
+              "ntt_fwd_rom layout mismatch");
+static_assert(ntt_inv_rom.v[0][(NTT_LAYERS - 1) * NTT_LANE_ITERS] == ntt_zetas_mont[127] &&
+              ntt_inv_rom.v[0][0] == ntt_zetas_mont[1], "ntt_inv_rom layout mismatch");
+static_assert(basemul_zeta_rom.v[0][0] == ntt_zetas_mont[64] &&
+              basemul_zeta_neg_rom.v[0][0] == to_mont(MLKEM_Q - 17), "basemul ROM mismatch");
+
+#define TWIDDLE_BANKED(rom) \
+    HLS_PRAGMA(HLS ARRAY_PARTITION variable=rom.v dim=1 complete)
+// Byte buffers (XOF/PRF output) are banked by the lcm of the 8-byte Keccak
+// lane width and the 3-byte sampler stride so producer and consumer both
+// run at II=1.
+#define BYTE_BANKS 24
+#define BYTES_BANKED(var) \
+    HLS_PRAGMA(HLS ARRAY_PARTITION variable=var cyclic factor=BYTE_BANKS)
+
 // Polynomial type
 struct poly_t {
     coeff_t coeffs[MLKEM_N];
@@ -87,14 +286,123 @@ struct matrix_t {
 // Reduction functions
 coeff_t montgomery_reduce(int32_t a);
 coeff_t barrett_reduce(coeff_t a);
+coeff_t barrett_reduce24(coeff_prod_t a);
+coeff_t barrett_reduce_acc(coeff_acc_t a);
+coeff_t montgomery_reduce24(coeff_prod_t a);
 coeff_t csubq(coeff_t a);
 
+// Bound-tracking coefficients. bounded_coeff<MaxVal> is a value known to lie
+// in [0, MaxVal], held in the narrowest ap_uint that fits. Sums, biased
+// differences and products carry their worst-case bound in the result type,
+// and bounded_reduce picks the cheapest reduction for that bound at compile
+// time: none below q, csubq below 2q, Barrett above. A datapath written with
+// them only builds the reductions its value ranges actually need.
+constexpr int bound_bits(uint64_t v) { return v < 2 ? 1 : 1 + bound_bits(v >> 1); }
+
+template <uint64_t MaxVal>
+struct bounded_coeff {
+    static const uint64_t bound = MaxVal;
+    typedef ap_uint<bound_bits(MaxVal)> value_t;
+    value_t v;
+
+    bounded_coeff() : v(0) {}
+    template <typename T>
+    explicit bounded_coeff(T x) : v(x) {}
+};
+
+template <uint64_t A, uint64_t B>
+inline bounded_coeff<A + B> operator+(bounded_coeff<A> a, bounded_coeff<B> b) {
+#pragma HLS INLINE
+    typedef typename bounded_coeff<A + B>::value_t R;
+    return bounded_coeff<A + B>((R)a.v + (R)b.v);
+}
+
+// a - b + k q with the smallest k that keeps the result non-negative
+template <uint64_t A, uint64_t B>
+inline bounded_coeff<A + (B + MLKEM_Q - 1) / MLKEM_Q * MLKEM_Q> operator-(bounded_coeff<A> a, bounded_coeff<B> b) {
+#pragma HLS INLINE
+    const uint64_t bias = (B + MLKEM_Q - 1) / MLKEM_Q * MLKEM_Q;
+    typedef typename bounded_coeff<A + bias>::value_t R;
+    return bounded_coeff<A + bias>((R)a.v + (R)bias - (R)b.v);
+}
+
+template <uint64_t A, uint64_t B>
+inline bounded_coeff<A * B> operator*(bounded_coeff<A> a, bounded_coeff<B> b) {
+#pragma HLS INLINE
+    typedef typename bounded_coeff<A * B>::value_t R;
+    return bounded_coeff<A * B>((R)a.v * (R)b.v);
+}
+
+// Reduction strategies by bound: 0 none, 1 csubq, 2 barrett_reduce24, 3 barrett_reduce_acc
+template <uint64_t MaxVal>
+struct bounded_reduction {
+    static_assert(MaxVal < (1u << 27), "bound exceeds the widest Barrett reduction");
+    static const int kind = MaxVal < MLKEM_Q ? 0 : MaxVal < 2 * MLKEM_Q ? 1 : MaxVal < (1u << 24) ? 2 : 3;
+};
+
+template <uint64_t M>
+inline coeff_t bounded_reduce_by(bounded_coeff<M> a, std::integral_constant<int, 0>) { return a.v; }
+template <uint64_t M>
+inline coeff_t bounded_reduce_by(bounded_coeff<M> a, std::integral_constant<int, 1>) { return csubq(a.v); }
+template <uint64_t M>
+inline coeff_t bounded_reduce_by(bounded_coeff<M> a, std::integral_constant<int, 2>) { return barrett_reduce24(a.v); }
+template <uint64_t M>
+inline coeff_t bounded_reduce_by(bounded_coeff<M> a, std::integral_constant<int, 3>) { return barrett_reduce_acc(a.v); }
+
+// Canonical representative in [0, q)
+template <uint64_t MaxVal>
+inline bounded_coeff<MLKEM_Q - 1> bounded_reduce(bounded_coeff<MaxVal> a) {
+#pragma HLS INLINE
+    return bounded_coeff<MLKEM_Q - 1>(
+        bounded_reduce_by(a, std::integral_constant<int, bounded_reduction<MaxVal>::kind>()));
+}
+
+// A stored coefficient, which the polynomial operations keep in [0, q)
+typedef bounded_coeff<MLKEM_Q - 1> coeff_q_t;
+
+static_assert(bound_bits(MLKEM_Q - 1) == 12 && bound_bits(2 * MLKEM_Q - 2) == 13 &&
+              bound_bits((MLKEM_Q - 1) * (MLKEM_Q - 1)) == 24, "bounded_coeff widths");
+static_assert(bounded_reduction<MLKEM_Q - 1>::kind == 0 && bounded_reduction<2 * MLKEM_Q - 2>::kind == 1 &&
+              bounded_reduction<(MLKEM_Q - 1) * (MLKEM_Q - 1)>::kind == 2, "bounded_coeff reductions");
+
 // NTT operations
 void ntt_forward(poly_t* r);
 void ntt_inverse(poly_t* r);
 
+// Streaming NTT/INTT. Two NTT engines are available, chosen at compile time:
+//   NTT_STREAMING=0  ntt_forward/ntt_inverse: one banked poly_t at a time,
+//                    a single butterfly array reused for all 7 layers
+//                    (minimum area)
+//   NTT_STREAMING=1  polyvec_ntt goes through ntt_stream_forward: 7
+//                    pipelined layers, each with its own butterflies and
+//                    delay-line commutator, NTT_STREAM_LANES coefficients per
+//                    cycle; back-to-back polynomials enter every
+//                    256 / NTT_STREAM_LANES cycles (maximum throughput)
+// Polynomials travel as coeff_vec_t vectors of consecutive coefficients in
+// natural order, MLKEM_N / NTT_STREAM_LANES vectors per polynomial.
+#ifndef NTT_STREAMING
+#define NTT_STREAMING 0
+#endif
+#ifndef NTT_STREAM_LANES
+#define NTT_STREAM_LANES 4
+#endif
+static_assert((NTT_STREAM_LANES & (NTT_STREAM_LANES - 1)) == 0 && NTT_STREAM_LANES <= POLY_BANKS,
+              "NTT_STREAM_LANES must be a power of two up to POLY_BANKS");
+
+struct coeff_vec_t {
+    coeff_t c[NTT_STREAM_LANES];
+};
+
+void ntt_stream_forward(hls::stream<coeff_vec_t>& in, hls::stream<coeff_vec_t>& out, int npolys);
+void ntt_stream_inverse(hls::stream<coeff_vec_t>& in, hls::stream<coeff_vec_t>& out, int npolys);
+// npolys polynomials from a through the streaming engine into r (r != a)
+void ntt_forward_polys(poly_t* r, const poly_t* a, int npolys);
+void ntt_inverse_polys(poly_t* r, const poly_t* a, int npolys);
+
 // Polynomial arithmetic
 void poly_basemul_montgomery(poly_t* r, const poly_t* a, const poly_t* b);
+void poly_basemul_precompute(poly_t* bz, const poly_t* b);
+void poly_basemul_acc(coeff_acc_t acc[4], const poly_t* a, const poly_t* b, const poly_t* bz, int c);
 void poly_add(poly_t* r, const poly_t* a, const poly_t* b);
 void poly_sub(poly_t* r, const poly_t* a, const poly_t* b);
 void poly_reduce(poly_t* r);
@@ -102,11 +410,23 @@ void poly_reduce(poly_t* r);
 // Polynomial sampling
 void poly_cbd_eta1(poly_t* r, const byte_t* buf);
 void poly_cbd_eta2(poly_t* r, const byte_t* buf);
-void poly_uniform(poly_t* r, const byte_t* seed, byte_t nonce);
+void poly_uniform(poly_t* r, const byte_t* seed, byte_t nonce, bool transposed);
 
 // Polynomial serialization
 void poly_tobytes(byte_t* r, const poly_t* a);
 void poly_frombytes(poly_t* r, const byte_t* a);
+void poly_tobeats(beat_t r[MLKEM_POLYBEATS], const poly_t* a);
+void poly_frombeats(poly_t* r, const beat_t a[MLKEM_POLYBEATS]);
+
+// Byte <-> beat packing
+void bytes_tobeats(beat_t* r, const byte_t* a, int nbeats);
+void beats_tobytes(byte_t* r, const beat_t* a, int nbeats);
+
+// Polynomial compression (dv = 4, du = 10)
+void poly_compress(byte_t r[MLKEM_POLYCOMPRESSEDBYTES_DV], const poly_t* a);
+void poly_decompress(poly_t* r, const byte_t a[MLKEM_POLYCOMPRESSEDBYTES_DV]);
+void poly_compress_du(byte_t r[MLKEM_POLYCOMPRESSEDBYTES_DU], const poly_t* a);
+void poly_decompress_du(poly_t* r, const byte_t a[MLKEM_POLYCOMPRESSEDBYTES_DU]);
 
 // ============================================================================
 // POLYNOMIAL VECTOR OPERATIONS
@@ -120,18 +440,14 @@ void polyvec_ntt(polyvec_t* r);
 void polyvec_add(polyvec_t* r, const polyvec_t* a, const polyvec_t* b);
 void polyvec_sub(polyvec_t* r, const polyvec_t* a, const polyvec_t* b);
 void polyvec_reduce(polyvec_t* r);
-void polyvec_pointwise_acc_montgomery(poly_t* r, const polyvec_t* a, const polyvec_t* b);
-void ntt_base_multiplication(int16_t *r0, int16_t *r1,
-                                           int16_t a0, int16_t a1,
-                                           int16_t b0, int16_t b1,
-                                           int16_t zeta);
+void polyvec_basemul_precompute(polyvec_t* bz, const polyvec_t* b);
+void polyvec_pointwise_acc_montgomery(poly_t* r, const polyvec_t* a, const polyvec_t* b, const polyvec_t* bz);
 // Matrix-vector operations
 void matrix_vector_mul(polyvec_t* r, const matrix_t* A, const polyvec_t* s);
-void matrix_transpose_vector_mul(polyvec_t* r, const matrix_t* A, const polyvec_t* s);
 
-// Matrix manipulation
-void matrix_expand(matrix_t* A, const byte_t* rho);
-void matrix_transpose(matrix_t* At, const matrix_t* A);
+// Matrix generation. transposed samples A^T in place of A (encaps), so
+// A^T * r is a plain matrix_vector_mul with no transpose pass.
+void matrix_expand(matrix_t* A, const byte_t* rho, bool transposed);
 
 // Vector sampling
 void polyvec_cbd_eta1(polyvec_t* r, const byte_t* buf);
@@ -140,6 +456,12 @@ void polyvec_cbd_eta2(polyvec_t* r, const byte_t* buf);
 // Vector serialization
 void polyvec_tobytes(byte_t* r, const polyvec_t* a);
 void polyvec_frombytes(polyvec_t* r, const byte_t* a);
+void polyvec_tobeats(beat_t r[MLKEM_K * MLKEM_POLYBEATS], const polyvec_t* a);
+void polyvec_frombeats(polyvec_t* r, const beat_t a[MLKEM_K * MLKEM_POLYBEATS]);
+
+// Vector compression (du = 10)
+void polyvec_compress(byte_t r[MLKEM_POLYVECCOMPRESSEDBYTES_DU], const polyvec_t* a);
+void polyvec_decompress(polyvec_t* r, const byte_t a[MLKEM_POLYVECCOMPRESSEDBYTES_DU]);
 
 // ============================================================================
 // CRYPTOGRAPHIC HASH FUNCTIONS
@@ -147,14 +469,23 @@ void polyvec_frombytes(polyvec_t* r, const byte_t* a);
 
 // Keccak permutation
 void keccak_f1600(lane_t state[25]);
+// KECCAK_STATES permutations sharing one round datapath
+void keccak_f1600_interleaved(lane_t state[KECCAK_STATES][25]);
 
 // SHA3-256 hash
 void sha3_256(const byte_t* input, int input_len, byte_t output[32]);
 
+// Incremental SHA3-256 over whole 64-bit lanes: the caller XORs message
+// lanes into state[0 .. 16] and permutes after each full block
+void sha3_256_init(lane_t state[25]);
+void sha3_256_final_beats(lane_t state[25], int lane, beat_t output[4]);
+
 void sha3_512(const byte_t* input, int input_len, byte_t output[64]);
 
 // SHAKE128 XOF
 void shake128(const byte_t* input, int input_len, byte_t* output, int output_len);
+void shake128_absorb(lane_t state[25], const byte_t* input, int input_len);
+void shake128_squeeze_block(lane_t state[25], bool first, byte_t output[SHAKE128_RATE]);
 
 // SHAKE256 XOF
 void shake256(const byte_t* input, int input_len, byte_t* output, int output_len);
@@ -177,12 +508,97 @@ void prf_eta(int eta, const byte_t s[32], byte_t b, byte_t* output);
 
 
 
-// Top-level key generation function for HLS
-void mlkem512_keygen_top(const byte_t seed[32],const byte_t z[32], byte_t pk[MLKEM_PUBLICKEYBYTES], byte_t sk[MLKEM_SECRETKEYBYTES]);
-
+// Key generation core
+void mlkem512_keygen(const byte_t seed[32],const byte_t z[32], beat_t pk[MLKEM_PUBLICKEYBEATS], beat_t sk[MLKEM_SECRETKEYBEATS]);
 
+// Top-level key generation function for HLS
+void mlkem512_keygen_top(const byte_t seed[32],const byte_t z[32], beat_t pk[MLKEM_PUBLICKEYBEATS], beat_t sk[MLKEM_SECRETKEYBEATS]);
+
+// Multi-core key generation: KEYGEN_CORES replicated cores fed round-robin
+// from a job list. Job n is KEYGEN_JOB_BEATS beats (d || z) at jobs[n * 8];
+// its keypair (pk || sk) is written to keys[n * KEYGEN_KEY_BEATS], after which
+// n + 1 is written to done_ring[n % ring_size]. Returns at once if
+// ring_size <= 0.
+#ifndef KEYGEN_CORES
+#define KEYGEN_CORES 2
+#endif
+const int KEYGEN_JOB_BEATS = 2 * MLKEM_SYMBEATS;                               // 8 beats
+const int KEYGEN_KEY_BEATS = MLKEM_PUBLICKEYBEATS + MLKEM_SECRETKEYBEATS;       // 304 beats
+
+void mlkem512_keygen_multi_top(const beat_t* jobs, beat_t* keys, ap_uint<32>* done_ring, int njobs, int ring_size);
+
+// Autonomous key pre-generation: an on-chip SHAKE256 DRBG supplies (d, z)
+// and keypairs are written into a DDR ring of ring_slots slots of
+// KEYGEN_KEY_BEATS beats (pk || sk). ring_ctrl is a small control block in
+// DDR shared with the host:
+//   [RING_HEAD]   keypairs produced so far (written by the core)
+//   [RING_TAIL]   keypairs consumed so far (written by the host)
+//   [RING_STOP]   non-zero asks the core to return after the current keypair
+//   [RING_STATUS] DRBG generate calls since the last reseed, with
+//                 RING_STATUS_RESEED set once reseeding is required
+// The core stalls while the ring is full and returns after nkeys keypairs
+// (nkeys = 0: until stopped). With reseed = 1 the 32-byte seed is mixed into
+// the DRBG key first. Returns the number of keypairs produced, 0 at once if
+// ring_slots <= 0.
+const int RING_HEAD = 0;
+const int RING_TAIL = 1;
+const int RING_STOP = 2;
+const int RING_STATUS = 3;
+const int RING_CTRL_WORDS = 4;
+const uint32_t RING_STATUS_RESEED = 1u << 31;
+const uint32_t DRBG_RESEED_INTERVAL = 1u << 20;   // Keypairs per seed
+
+void drbg_reseed(byte_t key[MLKEM_SYMBYTES], const byte_t seed[MLKEM_SYMBYTES]);
+void drbg_generate(byte_t key[MLKEM_SYMBYTES], uint32_t ctr, byte_t d[MLKEM_SYMBYTES], byte_t z[MLKEM_SYMBYTES]);
+int mlkem512_keygen_ring_top(const beat_t seed[MLKEM_SYMBEATS], int reseed, beat_t* ring,
+                             volatile uint32_t* ring_ctrl, int ring_slots, int nkeys);
+
+// Seed-form secret key: just (d, z), MLKEM_SEEDSKBYTES = 64 bytes in place
+// of the 1632-byte expanded sk, since s_hat, pk and H(pk) all follow from
+// it. mlkem512_sk_expand_top re-expands it for decapsulation and, in the
+// same dataflow region, unpacks the ciphertext: u (K polynomials,
+// du = 10) and v (dv = 4) are decompressed and written as
+// MLKEM_CTPOLYBEATS beats of 12-bit packed polynomials, u then v.
+const int MLKEM_SEEDSKBYTES = 2 * MLKEM_SYMBYTES;                                       // 64 bytes
+const int MLKEM_SEEDSKBEATS = MLKEM_SEEDSKBYTES / 8;                                    // 8 beats
+const int MLKEM_CIPHERTEXTBYTES = MLKEM_POLYVECCOMPRESSEDBYTES_DU + MLKEM_POLYCOMPRESSEDBYTES_DV;  // 768 bytes
+const int MLKEM_CIPHERTEXTBEATS = MLKEM_CIPHERTEXTBYTES / 8;                            // 96 beats
+const int MLKEM_CTPOLYBEATS = (MLKEM_K + 1) * MLKEM_POLYBEATS;                          // 144 beats
+
+void mlkem512_sk_expand_top(const beat_t sk_seed[MLKEM_SEEDSKBEATS], const beat_t ct[MLKEM_CIPHERTEXTBEATS],
+                            beat_t sk[MLKEM_SECRETKEYBEATS], beat_t ct_polys[MLKEM_CTPOLYBEATS]);
+
+// Batched encapsulation-key check (FIPS 203, 7.2): every 12-bit field of
+// t_hat in each of the npks public keys at pks[n * MLKEM_PUBLICKEYBEATS]
+// must be below q, which is exactly when ByteEncode(ByteDecode(pk)) == pk.
+// Bit n % 32 of valid[n / 32] is set for a valid key n (unused high bits of
+// the last word are cleared). Returns the number of invalid keys.
+const int PK_CHECK_GROUP_BEATS = 3;                                     // 16 coefficients per 3 beats
+const int PK_CHECK_POLY_BEATS = MLKEM_K * MLKEM_POLYBEATS;              // 96 beats of t_hat
+
+int mlkem512_pk_check_top(const beat_t* pks, int npks, ap_uint<32>* valid);
 
+// ============================================================================
+// BATCHED KECCAK ACCELERATOR
+// ============================================================================
 
+// General-purpose SHA3/SHAKE offload. desc holds ndesc descriptors of
+// KECCAK_DESC_BEATS beats:
+//   beat 0: [31:0] input offset   [63:32] input length   (bytes)
+//   beat 1: [31:0] output offset  [55:32] output length  [63:56] mode
+// Offsets index the in/out buffers in bytes and must be multiples of 8;
+// both buffers are accessed in whole beats, so the last output beat of a
+// request is written in full (zero past the output length). SHA3 modes
+// produce at most their digest length. Descriptors are processed in groups
+// of KECCAK_STATES, one sponge per interleaved state. Returns the number of
+// descriptors skipped for an unknown mode.
+const int KECCAK_DESC_BEATS = 2;
+const int KECCAK_MODE_SHA3_256 = 0;
+const int KECCAK_MODE_SHA3_512 = 1;
+const int KECCAK_MODE_SHAKE128 = 2;
+const int KECCAK_MODE_SHAKE256 = 3;
+
+int keccak_batch_top(const beat_t* desc, int ndesc, const beat_t* in, beat_t* out);
 
 
 
@@ -0,0 +1,194 @@
+#include "hybrid_scheduler.h"
+#include "secure_wipe.h"
+#include "soft_keygen.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+// Weight of a new sample in the moving averages
+static const double EWMA_ALPHA = 0.125;
+
+// How long the destructor waits for the core to finish timed-out jobs
+static const int ORPHAN_DRAIN_MS = 1000;
+
+static void ewma_update(double& avg, double sample) {
+    avg = avg == 0 ? sample : avg + EWMA_ALPHA * (sample - avg);
+}
+
+static double elapsed_us(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+}
+
+HybridScheduler::HybridScheduler(KeygenDriver* fpga, int cpu_threads, int fpga_timeout_ms)
+    : fpga_(fpga), cpu_threads_(cpu_threads), fpga_timeout_ms_(fpga_timeout_ms), stop_(false),
+      fpga_inflight_(0), cpu_pending_(0) {
+    if (cpu_threads <= 0)
+        throw std::invalid_argument("HybridScheduler: need at least one CPU worker to fail over to");
+
+    memset(&stats_, 0, sizeof(stats_));
+    stats_.fpga_online = true;
+
+    for (int i = 0; i < cpu_threads; i++)
+        workers_.push_back(std::thread(&HybridScheduler::cpu_worker, this));
+}
+
+HybridScheduler::~HybridScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        stop_ = true;
+    }
+    cpu_cv_.notify_all();
+    for (size_t i = 0; i < workers_.size(); i++)
+        workers_[i].join();
+
+    // Hand the slots of timed-out jobs back to the driver. One the core never
+    // finishes stays acquired: the core could still write into it.
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ORPHAN_DRAIN_MS);
+    for (;;) {
+        reap_orphans();
+        if (orphans_.empty() || std::chrono::steady_clock::now() >= deadline)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void HybridScheduler::keygen(const uint8_t d[32], const uint8_t z[32], uint8_t pk[800], uint8_t sk[1632]) {
+    reap_orphans();
+
+    bool use_fpga;
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        double fpga_est = (fpga_inflight_ + 1) * stats_.fpga_service_us;
+        double cpu_est = (cpu_pending_ / (cpu_threads_ * SOFT_KEYGEN_LANES) + 1) * stats_.cpu_batch_us;
+        use_fpga = stats_.fpga_online && fpga_est <= cpu_est;
+    }
+
+    if (use_fpga && keygen_fpga(d, z, pk, sk))
+        return;
+    keygen_cpu(d, z, pk, sk);
+}
+
+void HybridScheduler::set_fpga_online(bool online) {
+    reap_orphans();
+    std::lock_guard<std::mutex> lock(m_);
+    stats_.fpga_online = online;
+}
+
+HybridStats HybridScheduler::stats() {
+    std::lock_guard<std::mutex> lock(m_);
+    HybridStats s = stats_;
+    s.orphaned = orphans_.size();
+    return s;
+}
+
+// One job on the core. False if no slot was free or the job timed out;
+// the caller then runs it on the CPU.
+bool HybridScheduler::keygen_fpga(const uint8_t d[32], const uint8_t z[32], uint8_t pk[800], uint8_t sk[1632]) {
+    int slot = fpga_->try_acquire();
+    if (slot < 0)
+        return false;
+
+    int depth;
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        depth = ++fpga_inflight_;
+    }
+
+    memcpy(fpga_->d(slot), d, KEYGEN_SEEDBYTES);
+    memcpy(fpga_->z(slot), z, KEYGEN_SEEDBYTES);
+    auto t0 = std::chrono::steady_clock::now();
+    fpga_->submit(slot);
+    bool done = fpga_->wait_for(slot, fpga_timeout_ms_);
+    double us = elapsed_us(t0);
+
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        fpga_inflight_--;
+        if (!done) {
+            orphans_.push_back(slot);
+            stats_.fpga_online = false;
+            stats_.failovers++;
+            return false;
+        }
+        // The job waited behind the others in flight: charge it its share
+        ewma_update(stats_.fpga_service_us, us / depth);
+        stats_.fpga_jobs++;
+    }
+
+    memcpy(pk, fpga_->pk(slot), KEYGEN_PUBLICKEYBYTES);
+    memcpy(sk, fpga_->sk(slot), KEYGEN_SECRETKEYBYTES);
+    fpga_->release(slot);
+    return true;
+}
+
+void HybridScheduler::keygen_cpu(const uint8_t d[32], const uint8_t z[32], uint8_t pk[800], uint8_t sk[1632]) {
+    CpuJob job = {d, z, pk, sk, false};
+
+    std::unique_lock<std::mutex> lock(m_);
+    cpu_queue_.push_back(&job);
+    cpu_pending_++;
+    cpu_cv_.notify_one();
+    done_cv_.wait(lock, [&] { return job.done; });
+}
+
+// Release the slots of timed-out jobs the core has since finished
+void HybridScheduler::reap_orphans() {
+    std::lock_guard<std::mutex> lock(m_);
+    for (size_t i = 0; i < orphans_.size();) {
+        if (fpga_->poll(orphans_[i])) {
+            fpga_->release(orphans_[i]);
+            orphans_.erase(orphans_.begin() + i);
+        } else {
+            i++;
+        }
+    }
+}
+
+void HybridScheduler::cpu_worker() {
+    const size_t key_bytes = KEYGEN_PUBLICKEYBYTES + KEYGEN_SECRETKEYBYTES;
+    std::vector<uint8_t> out(SOFT_KEYGEN_LANES * key_bytes);
+    uint8_t d[SOFT_KEYGEN_LANES][32], z[SOFT_KEYGEN_LANES][32];
+
+    for (;;) {
+        CpuJob* jobs[SOFT_KEYGEN_LANES];
+        int n = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_);
+            cpu_cv_.wait(lock, [&] { return stop_ || !cpu_queue_.empty(); });
+            if (cpu_queue_.empty())
+                return;
+            while (n < SOFT_KEYGEN_LANES && !cpu_queue_.empty()) {
+                jobs[n++] = cpu_queue_.front();
+                cpu_queue_.pop_front();
+            }
+        }
+
+        for (int i = 0; i < n; i++) {
+            memcpy(d[i], jobs[i]->d, KEYGEN_SEEDBYTES);
+            memcpy(z[i], jobs[i]->z, KEYGEN_SEEDBYTES);
+        }
+        auto t0 = std::chrono::steady_clock::now();
+        soft_keygen_batch(n, d, z, out.data(), key_bytes);
+        double us = elapsed_us(t0);
+
+        for (int i = 0; i < n; i++) {
+            memcpy(jobs[i]->pk, &out[i * key_bytes], KEYGEN_PUBLICKEYBYTES);
+            memcpy(jobs[i]->sk, &out[i * key_bytes + KEYGEN_PUBLICKEYBYTES], KEYGEN_SECRETKEYBYTES);
+        }
+
+        secure_wipe(out.data(), out.size());
+        secure_wipe(d, sizeof(d));
+        secure_wipe(z, sizeof(z));
+
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            for (int i = 0; i < n; i++)
+                jobs[i]->done = true;
+            cpu_pending_ -= n;
+            stats_.cpu_jobs += n;
+            ewma_update(stats_.cpu_batch_us, us);
+        }
+        done_cv_.notify_all();
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef MLKEM_HYBRID_SCHEDULER_H
+#define MLKEM_HYBRID_SCHEDULER_H
+
+#include "mlkem_driver.h"
+
+// ============================================================================
+// HYBRID FPGA / CPU SCHEDULER
+// ============================================================================
+
+struct HybridStats {
+    uint64_t fpga_jobs;         // Keypairs returned by the core
+    uint64_t cpu_jobs;          // Keypairs returned by the software workers
+    uint64_t failovers;         // Core jobs that timed out and were redone on the CPU
+    size_t orphaned;            // Timed-out core slots not yet released
+    bool fpga_online;
+    double fpga_service_us;     // Estimated core time per job
+    double cpu_batch_us;        // Estimated time per soft_keygen_batch call
+};
+
+// Routes each keygen() to the core (through KeygenDriver) or to a pool of
+// CPU workers running soft_keygen_batch, whichever is expected to finish it
+// first given what is already queued on each:
+//
+//   core:  (jobs in flight + 1) * fpga_service_us
+//   CPU:   (jobs pending / (threads * lanes) + 1) * cpu_batch_us
+//
+// Both estimates are moving averages of measured times, starting at zero so
+// each backend is tried before it is measured; ties go to the core. The CPU
+// workers take up to SOFT_KEYGEN_LANES pending jobs per batch, so a burst
+// fills the SIMD lanes.
+//
+// Failover: while the core is offline (set_fpga_online(false), e.g. during
+// a bitstream reload) everything runs on the CPU. A core job that takes
+// longer than fpga_timeout_ms is redone on the CPU and takes the core
+// offline until set_fpga_online(true); its slot is released once the core
+// finally reports it done, which the destructor waits up to a second for.
+// Callers never see either case.
+class HybridScheduler {
+public:
+    HybridScheduler(KeygenDriver* fpga, int cpu_threads, int fpga_timeout_ms = 100);
+    ~HybridScheduler();
+
+    // Blocking keygen, safe to call from any number of threads
+    void keygen(const uint8_t d[32], const uint8_t z[32], uint8_t pk[800], uint8_t sk[1632]);
+
+    void set_fpga_online(bool online);
+    HybridStats stats();
+
+private:
+    struct CpuJob {
+        const uint8_t* d;
+        const uint8_t* z;
+        uint8_t* pk;
+        uint8_t* sk;
+        bool done;
+    };
+
+    bool keygen_fpga(const uint8_t d[32], const uint8_t z[32], uint8_t pk[800], uint8_t sk[1632]);
+    void keygen_cpu(const uint8_t d[32], const uint8_t z[32], uint8_t pk[800], uint8_t sk[1632]);
+    void reap_orphans();
+    void cpu_worker();
+
+    KeygenDriver* fpga_;
+    int cpu_threads_;
+    int fpga_timeout_ms_;
+
+    std::mutex m_;
+    std::condition_variable cpu_cv_;        // Work for the CPU workers
+    std::condition_variable done_cv_;       // A CPU job finished
+    std::deque<CpuJob*> cpu_queue_;
+    std::vector<std::thread> workers_;
+    std::vector<int> orphans_;
+    bool stop_;
+
+    int fpga_inflight_;
+    int cpu_pending_;       // Queued or running on a worker
+    HybridStats stats_;
+};
+
+#endif // MLKEM_HYBRID_SCHEDULER_H
@@ -0,0 +1,266 @@
+#include "keypair_pool.h"
+#include "secure_wipe.h"
+#include "soft_keygen.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/random.h>
+#include <unistd.h>
+#ifdef MLKEM_MOCK
+#include "unified.h"
+#endif
+
+// Refill back-off after a source failure: doubles per consecutive failure
+static const int REFILL_BACKOFF_MIN_MS = 10;
+static const int REFILL_BACKOFF_MAX_MS = 1000;
+
+static void random_bytes(uint8_t* buf, size_t n) {
+    while (n > 0) {
+        ssize_t r = getrandom(buf, n, 0);
+        if (r < 0)
+            throw std::runtime_error("KeypairSource: getrandom failed");
+        buf += r;
+        n -= (size_t)r;
+    }
+}
+
+// ============================================================================
+// KEYPAIR SOURCES
+// ============================================================================
+
+void DriverKeypairSource::generate(int n, uint8_t* dst, size_t stride) {
+    std::vector<int> slot_of(n, -1);
+    int next_submit = 0;
+
+    for (int k = 0; k < n; k++) {
+        // Top up the queue before blocking on the oldest job
+        while (next_submit < n) {
+            int slot = next_submit == k ? drv_->acquire() : drv_->try_acquire();
+            if (slot < 0)
+                break;
+            random_bytes(drv_->d(slot), KEYGEN_SEEDBYTES);
+            random_bytes(drv_->z(slot), KEYGEN_SEEDBYTES);
+            drv_->submit(slot);
+            slot_of[next_submit++] = slot;
+        }
+
+        int slot = slot_of[k];
+        drv_->wait(slot);
+        memcpy(dst + k * stride, drv_->pk(slot), KEYGEN_PUBLICKEYBYTES);
+        memcpy(dst + k * stride + KEYGEN_PUBLICKEYBYTES, drv_->sk(slot), KEYGEN_SECRETKEYBYTES);
+        drv_->release(slot);
+    }
+}
+
+void RingKeypairSource::generate(int n, uint8_t* dst, size_t stride) {
+    for (int k = 0; k < n; k++) {
+        uint8_t* pk = dst + k * stride;
+        while (!ring_->pop(pk, pk + KEYGEN_PUBLICKEYBYTES)) {
+            if (ring_->reseed_required()) {
+                uint8_t seed[32];
+                random_bytes(seed, sizeof(seed));
+                ring_->seed(seed);
+                secure_wipe(seed, sizeof(seed));
+                ring_->start();
+            }
+            std::this_thread::yield();
+        }
+    }
+}
+
+void BatchSoftwareKeypairSource::generate(int n, uint8_t* dst, size_t stride) {
+    uint8_t d[SOFT_KEYGEN_LANES][32], z[SOFT_KEYGEN_LANES][32];
+
+    for (int k = 0; k < n; k += SOFT_KEYGEN_LANES) {
+        int batch = std::min(n - k, SOFT_KEYGEN_LANES);
+        random_bytes(d[0], sizeof(d));
+        random_bytes(z[0], sizeof(z));
+        soft_keygen_batch(batch, d, z, dst + k * stride, stride);
+    }
+
+    secure_wipe(d, sizeof(d));
+    secure_wipe(z, sizeof(z));
+}
+
+#ifdef MLKEM_MOCK
+void SoftwareKeypairSource::generate(int n, uint8_t* dst, size_t stride) {
+    uint8_t seed[2 * KEYGEN_SEEDBYTES];
+    byte_t d[32], z[32];
+    beat_t pk[MLKEM_PUBLICKEYBEATS], sk[MLKEM_SECRETKEYBEATS];
+
+    for (int k = 0; k < n; k++) {
+        random_bytes(seed, sizeof(seed));
+        for (int i = 0; i < 32; i++) {
+            d[i] = seed[i];
+            z[i] = seed[32 + i];
+        }
+        mlkem512_keygen_top(d, z, pk, sk);
+
+        uint8_t* out = dst + k * stride;
+        for (int i = 0; i < MLKEM_PUBLICKEYBYTES; i++)
+            out[i] = (uint8_t)(pk[i / 8] >> (8 * (i % 8)));
+        for (int i = 0; i < MLKEM_SECRETKEYBYTES; i++)
+            out[KEYGEN_PUBLICKEYBYTES + i] = (uint8_t)(sk[i / 8] >> (8 * (i % 8)));
+    }
+
+    secure_wipe(seed, sizeof(seed));
+    for (int i = 0; i < 32; i++)
+        d[i] = z[i] = 0;
+    for (int i = 0; i < MLKEM_SECRETKEYBEATS; i++)
+        sk[i] = 0;
+}
+#endif
+
+// ============================================================================
+// KEYPAIR POOL
+// ============================================================================
+
+KeypairPool::KeypairPool(KeypairSource* src, int capacity, int low_water, int refill_chunk)
+    : src_(src), capacity_(capacity), low_water_(low_water), chunk_(refill_chunk),
+      locked_(false), stop_(false), head_(0), count_(0), pop_ns_total_(0), refill_s_total_(0) {
+    if (capacity <= 0 || refill_chunk <= 0)
+        throw std::invalid_argument("KeypairPool: need a positive capacity and refill chunk");
+    if (low_water < 0 || low_water > capacity)
+        throw std::invalid_argument("KeypairPool: low-water mark outside [0, capacity]");
+
+    // Pool slots, then one refill chunk of staging, rounded up to whole pages
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    arena_bytes_ = ((capacity_ + chunk_) * KEY_BYTES + page - 1) / page * page;
+    void* p = mmap(nullptr, arena_bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+        throw std::runtime_error("KeypairPool: cannot map arena");
+    arena_ = (uint8_t*)p;
+
+    // Keep secret keys out of swap and core dumps. mlock() fails without
+    // CAP_IPC_LOCK beyond RLIMIT_MEMLOCK; the pool still works, unlocked.
+    locked_ = mlock(arena_, arena_bytes_) == 0;
+#ifdef MADV_DONTDUMP
+    madvise(arena_, arena_bytes_, MADV_DONTDUMP);
+#endif
+
+    memset(&stats_, 0, sizeof(stats_));
+    refill_ = std::thread(&KeypairPool::refill, this);
+}
+
+KeypairPool::~KeypairPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    refill_.join();
+
+    stats_.evicted += count_;
+    secure_wipe(arena_, arena_bytes_);
+    if (locked_)
+        munlock(arena_, arena_bytes_);
+    munmap(arena_, arena_bytes_);
+}
+
+// Copy out and wipe the oldest slot. Caller holds m_ and count_ > 0.
+bool KeypairPool::take(uint8_t pk[800], uint8_t sk[1632]) {
+    uint8_t* s = slot(head_);
+    memcpy(pk, s, KEYGEN_PUBLICKEYBYTES);
+    memcpy(sk, s + KEYGEN_PUBLICKEYBYTES, KEYGEN_SECRETKEYBYTES);
+    secure_wipe(s, KEY_BYTES);
+
+    head_ = (head_ + 1) % capacity_;
+    count_--;
+    stats_.pops++;
+    if (count_ < low_water_)
+        cv_.notify_all();
+    return true;
+}
+
+bool KeypairPool::pop(uint8_t pk[800], uint8_t sk[1632]) {
+    auto t0 = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(m_);
+    if (count_ == 0) {
+        stats_.misses++;
+        return false;
+    }
+    take(pk, sk);
+
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    pop_ns_total_ += ns;
+    stats_.pop_ns_max = std::max(stats_.pop_ns_max, ns);
+    return true;
+}
+
+void KeypairPool::pop_wait(uint8_t pk[800], uint8_t sk[1632]) {
+    std::unique_lock<std::mutex> lock(m_);
+    cv_.wait(lock, [this] { return count_ > 0; });
+    take(pk, sk);
+}
+
+size_t KeypairPool::level() {
+    std::lock_guard<std::mutex> lock(m_);
+    return count_;
+}
+
+void KeypairPool::flush() {
+    std::lock_guard<std::mutex> lock(m_);
+    for (size_t i = 0; i < count_; i++)
+        secure_wipe(slot(head_ + i), KEY_BYTES);
+    stats_.evicted += count_;
+    head_ = 0;
+    count_ = 0;
+    cv_.notify_all();
+}
+
+PoolMetrics KeypairPool::metrics() {
+    std::lock_guard<std::mutex> lock(m_);
+    PoolMetrics m = stats_;
+    m.level = count_;
+    m.pop_ns_avg = stats_.pops ? pop_ns_total_ / stats_.pops : 0;
+    m.refill_keys_per_s = refill_s_total_ > 0 ? stats_.generated / refill_s_total_ : 0;
+    return m;
+}
+
+// Refill thread: sleep until the level drops below the low-water mark, then
+// top the pool up to capacity a chunk at a time. The source writes into
+// staging outside the lock, so pops are never held up by a keygen. A source
+// that throws is counted and retried after a back-off.
+void KeypairPool::refill() {
+    int backoff_ms = REFILL_BACKOFF_MIN_MS;
+    std::unique_lock<std::mutex> lock(m_);
+    for (;;) {
+        cv_.wait(lock, [this] { return stop_ || count_ < low_water_ || count_ == 0; });
+        while (!stop_ && count_ < capacity_) {
+            size_t n = std::min(chunk_, capacity_ - count_);
+            lock.unlock();
+
+            bool failed = false;
+            auto t0 = std::chrono::steady_clock::now();
+            try {
+                src_->generate((int)n, staging(), KEY_BYTES);
+            } catch (const std::exception&) {
+                failed = true;
+            }
+            double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+            lock.lock();
+            if (failed) {
+                // Part of the chunk may have been written
+                secure_wipe(staging(), n * KEY_BYTES);
+                stats_.refill_errors++;
+                cv_.wait_for(lock, std::chrono::milliseconds(backoff_ms), [this] { return stop_; });
+                backoff_ms = std::min(2 * backoff_ms, REFILL_BACKOFF_MAX_MS);
+                continue;
+            }
+            backoff_ms = REFILL_BACKOFF_MIN_MS;
+            // Pops only shrink count_, so the chunk still fits
+            for (size_t i = 0; i < n; i++)
+                memcpy(slot(head_ + count_ + i), staging() + i * KEY_BYTES, KEY_BYTES);
+            secure_wipe(staging(), n * KEY_BYTES);
+            count_ += n;
+            stats_.generated += n;
+            refill_s_total_ += s;
+            cv_.notify_all();
+        }
+        if (stop_)
+            return;
+    }
+}
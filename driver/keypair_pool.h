@@ -0,0 +1,128 @@
+#ifndef MLKEM_KEYPAIR_POOL_H
+#define MLKEM_KEYPAIR_POOL_H
+
+#include "mlkem_driver.h"
+
+// ============================================================================
+// KEYPAIR SOURCES
+// ============================================================================
+
+// Anything that can produce fresh keypairs. generate() writes n keypairs
+// back to back: keypair i is pk at dst + i * stride, sk 800 bytes later.
+class KeypairSource {
+public:
+    virtual ~KeypairSource() {}
+    virtual void generate(int n, uint8_t* dst, size_t stride) = 0;
+};
+
+// mlkem512_keygen_top through KeygenDriver, with (d, z) from getrandom().
+// Keeps every driver slot busy while a batch is outstanding.
+class DriverKeypairSource : public KeypairSource {
+public:
+    explicit DriverKeypairSource(KeygenDriver* drv) : drv_(drv) {}
+    void generate(int n, uint8_t* dst, size_t stride);
+
+private:
+    KeygenDriver* drv_;
+};
+
+// mlkem512_keygen_ring_top through KeypairRing (seeded and started by the
+// caller): waits for and pops ready keypairs
+class RingKeypairSource : public KeypairSource {
+public:
+    explicit RingKeypairSource(KeypairRing* ring) : ring_(ring) {}
+    void generate(int n, uint8_t* dst, size_t stride);
+
+private:
+    KeypairRing* ring_;
+};
+
+// Batched software fallback: soft_keygen_batch on the calling thread,
+// SOFT_KEYGEN_LANES keypairs per call, with (d, z) from getrandom().
+// Needs no device and no Vitis headers.
+class BatchSoftwareKeypairSource : public KeypairSource {
+public:
+    void generate(int n, uint8_t* dst, size_t stride);
+};
+
+#ifdef MLKEM_MOCK
+// Software fallback: the C model of the keygen core on the calling thread,
+// with (d, z) from getrandom(). Only in builds that link the HLS sources;
+// one keypair at a time, the baseline for BatchSoftwareKeypairSource.
+class SoftwareKeypairSource : public KeypairSource {
+public:
+    void generate(int n, uint8_t* dst, size_t stride);
+};
+#endif
+
+// ============================================================================
+// KEYPAIR POOL
+// ============================================================================
+
+struct PoolMetrics {
+    size_t level;               // Keypairs ready now
+    uint64_t pops;              // Successful pops
+    uint64_t misses;            // pop() calls that found the pool empty
+    uint64_t generated;         // Keypairs added by refills
+    uint64_t evicted;           // Keypairs wiped unused (flush, shutdown)
+    uint64_t refill_errors;     // Refill chunks whose source threw
+    double pop_ns_avg;          // pop() latency, successful pops only
+    double pop_ns_max;
+    double refill_keys_per_s;   // Source throughput over all refill chunks
+};
+
+// Bounded pool of ready keypairs for per-connection ephemeral keys. The
+// pool lives in an mlock()ed, non-dumpable arena; a refill thread tops it
+// up to capacity from the source, in chunks of refill_chunk, whenever the
+// level drops below low_water. pop() is a copy out of the arena under a
+// mutex. Every slot is wiped as soon as its keypair leaves the pool, on
+// flush() and on destruction. A refill whose source throws is counted in
+// refill_errors and retried after a back-off of 10 ms, doubling up to 1 s.
+class KeypairPool {
+public:
+    KeypairPool(KeypairSource* src, int capacity, int low_water, int refill_chunk = 8);
+    ~KeypairPool();
+
+    // Take the oldest keypair. Non-blocking: returns false (a miss) when empty.
+    bool pop(uint8_t pk[800], uint8_t sk[1632]);
+    // Block until a keypair is available
+    void pop_wait(uint8_t pk[800], uint8_t sk[1632]);
+
+    size_t level();
+    // Wipe every ready keypair; the refill thread then starts over
+    void flush();
+    PoolMetrics metrics();
+
+    // False if the arena could not be locked (RLIMIT_MEMLOCK); still wiped
+    bool locked() const { return locked_; }
+
+private:
+    static const size_t KEY_BYTES = KEYGEN_PUBLICKEYBYTES + KEYGEN_SECRETKEYBYTES;
+
+    uint8_t* slot(size_t i) { return arena_ + (i % capacity_) * KEY_BYTES; }
+    uint8_t* staging() { return arena_ + capacity_ * KEY_BYTES; }
+    bool take(uint8_t pk[800], uint8_t sk[1632]);
+    void refill();
+
+    KeypairSource* src_;
+    size_t capacity_;
+    size_t low_water_;
+    size_t chunk_;
+
+    uint8_t* arena_;
+    size_t arena_bytes_;
+    bool locked_;
+
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::thread refill_;
+    bool stop_;
+    size_t head_;       // Index of the oldest ready keypair
+    size_t count_;      // Ready keypairs
+
+    PoolMetrics stats_;
+    double pop_ns_total_;
+    double refill_s_total_;
+};
+
+#endif // MLKEM_KEYPAIR_POOL_H
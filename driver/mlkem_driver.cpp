@@ -0,0 +1,295 @@
+#include "mlkem_driver.h"
+#include "secure_wipe.h"
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+KeygenDriver::KeygenDriver(Device* dev, int slots, bool use_irq)
+    : dev_(dev), use_irq_(use_irq), state_(slots, SLOT_FREE), stop_(false), completed_(0) {
+    if (slots <= 0)
+        throw std::invalid_argument("KeygenDriver: need at least one slot");
+
+    // All slots come from one contiguous allocation made up front
+    mem_ = dev_->alloc((size_t)slots * SLOT_BYTES);
+
+    // Enable the ap_done interrupt if requested, otherwise keep it masked
+    dev_->write_reg(REG_IP_IER, use_irq_ ? 1 : 0);
+    dev_->write_reg(REG_GIER, use_irq_ ? 1 : 0);
+
+    worker_ = std::thread(&KeygenDriver::worker, this);
+}
+
+KeygenDriver::~KeygenDriver() {
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    worker_.join();
+
+    // Seeds and secret keys may still sit in the slots
+    secure_wipe(mem_.virt, mem_.size);
+    dev_->sync_to_device(mem_, 0, mem_.size);
+    dev_->free(mem_);
+}
+
+int KeygenDriver::try_acquire() {
+    std::lock_guard<std::mutex> lock(m_);
+    for (int i = 0; i < slots(); i++) {
+        if (state_[i] == SLOT_FREE) {
+            state_[i] = SLOT_OWNED;
+            return i;
+        }
+    }
+    return -1;
+}
+
+int KeygenDriver::acquire() {
+    std::unique_lock<std::mutex> lock(m_);
+    for (;;) {
+        for (int i = 0; i < slots(); i++) {
+            if (state_[i] == SLOT_FREE) {
+                state_[i] = SLOT_OWNED;
+                return i;
+            }
+        }
+        cv_.wait(lock);
+    }
+}
+
+void KeygenDriver::submit(int slot) {
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        if (state_[slot] != SLOT_OWNED)
+            throw std::logic_error("KeygenDriver: submit of a slot that is not owned");
+        state_[slot] = SLOT_QUEUED;
+        queue_.push_back(slot);
+    }
+    cv_.notify_all();
+}
+
+bool KeygenDriver::poll(int slot) {
+    std::lock_guard<std::mutex> lock(m_);
+    return state_[slot] == SLOT_DONE;
+}
+
+void KeygenDriver::wait(int slot) {
+    std::unique_lock<std::mutex> lock(m_);
+    cv_.wait(lock, [&] { return state_[slot] == SLOT_DONE; });
+}
+
+bool KeygenDriver::wait_for(int slot, int timeout_ms) {
+    std::unique_lock<std::mutex> lock(m_);
+    return cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [&] { return state_[slot] == SLOT_DONE; });
+}
+
+void KeygenDriver::release(int slot) {
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        if (state_[slot] == SLOT_QUEUED || state_[slot] == SLOT_RUNNING)
+            throw std::logic_error("KeygenDriver: release of a slot still in flight");
+        // d and z rebuild the whole keypair: wipe them along with sk
+        secure_wipe(slot_base(slot), SLOT_BYTES);
+        dev_->sync_to_device(mem_, (size_t)slot * SLOT_BYTES, SLOT_BYTES);
+        state_[slot] = SLOT_FREE;
+    }
+    cv_.notify_all();
+}
+
+void KeygenDriver::keygen(const uint8_t d_in[32], const uint8_t z_in[32], uint8_t pk_out[800], uint8_t sk_out[1632]) {
+    int slot = acquire();
+    memcpy(d(slot), d_in, KEYGEN_SEEDBYTES);
+    memcpy(z(slot), z_in, KEYGEN_SEEDBYTES);
+    submit(slot);
+    wait(slot);
+    memcpy(pk_out, pk(slot), KEYGEN_PUBLICKEYBYTES);
+    memcpy(sk_out, sk(slot), KEYGEN_SECRETKEYBYTES);
+    release(slot);
+}
+
+void KeygenDriver::write_addr(uint32_t offset, uint64_t addr) {
+    dev_->write_reg(offset, (uint32_t)addr);
+    dev_->write_reg(offset + 4, (uint32_t)(addr >> 32));
+}
+
+// Program one job, start the core and wait for ap_done
+void KeygenDriver::run_job(int slot) {
+    size_t base = (size_t)slot * SLOT_BYTES;
+    uint64_t phys = slot_phys(slot);
+
+    dev_->sync_to_device(mem_, base, 2 * KEYGEN_SEEDBYTES);
+
+    write_addr(REG_D, phys);
+    write_addr(REG_Z, phys + KEYGEN_SEEDBYTES);
+    write_addr(REG_PK, phys + PK_OFFSET);
+    write_addr(REG_SK, phys + SK_OFFSET);
+    dev_->write_reg(REG_CTRL, CTRL_AP_START);
+
+    for (;;) {
+        if (use_irq_ && dev_->wait_irq(100)) {
+            // Acknowledge ap_done in the IP, then confirm via CTRL
+            dev_->write_reg(REG_IP_ISR, 1);
+        }
+        // ap_done is clear-on-read; ap_idle stays set until the next start
+        uint32_t ctrl = dev_->read_reg(REG_CTRL);
+        if (ctrl & (CTRL_AP_DONE | CTRL_AP_IDLE))
+            break;
+        if (!use_irq_)
+            std::this_thread::yield();
+    }
+
+    dev_->sync_from_device(mem_, base + PK_OFFSET, KEYGEN_PUBLICKEYBYTES + KEYGEN_SECRETKEYBYTES);
+}
+
+void KeygenDriver::worker() {
+    for (;;) {
+        int slot;
+        {
+            std::unique_lock<std::mutex> lock(m_);
+            cv_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+            if (queue_.empty())
+                return;
+            slot = queue_.front();
+            queue_.pop_front();
+            state_[slot] = SLOT_RUNNING;
+        }
+
+        run_job(slot);
+
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            state_[slot] = SLOT_DONE;
+            completed_++;
+        }
+        cv_.notify_all();
+    }
+}
+
+KeypairRing::KeypairRing(Device* dev, int slots)
+    : dev_(dev), slots_(slots), ring_bytes_((size_t)slots * KEY_BYTES), tail_(0),
+      started_(false), reseed_pending_(false), popped_(0) {
+    if (slots <= 0)
+        throw std::invalid_argument("KeypairRing: need at least one slot");
+
+    // slots * (pk || sk) | control words | seed
+    mem_ = dev_->alloc(ring_bytes_ + CTRL_BYTES + KEYGEN_SEEDBYTES);
+    memset(mem_.virt, 0, mem_.size);
+    dev_->sync_to_device(mem_, 0, mem_.size);
+
+    // The ring core is only ever polled
+    dev_->write_reg(REG_IP_IER, 0);
+    dev_->write_reg(REG_GIER, 0);
+}
+
+KeypairRing::~KeypairRing() {
+    stop();
+
+    // Unconsumed secret keys and the seed sit in the ring buffer
+    secure_wipe(mem_.virt, mem_.size);
+    dev_->sync_to_device(mem_, 0, mem_.size);
+    dev_->free(mem_);
+}
+
+uint32_t KeypairRing::read_word(int word) {
+    dev_->sync_from_device(mem_, ring_bytes_ + 4 * word, 4);
+    uint32_t v = ctrl()[word];
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return v;
+}
+
+void KeypairRing::write_word(int word, uint32_t value) {
+    std::atomic_thread_fence(std::memory_order_release);
+    ctrl()[word] = value;
+    dev_->sync_to_device(mem_, ring_bytes_ + 4 * word, 4);
+}
+
+void KeypairRing::write_addr(uint32_t offset, uint64_t addr) {
+    dev_->write_reg(offset, (uint32_t)addr);
+    dev_->write_reg(offset + 4, (uint32_t)(addr >> 32));
+}
+
+void KeypairRing::seed(const uint8_t seed[32]) {
+    std::lock_guard<std::mutex> lock(m_);
+    bool was_running = started_;
+    if (was_running) {
+        write_word(RING_WORD_STOP, 1);
+        wait_idle();
+        write_word(RING_WORD_STOP, 0);
+    }
+
+    memcpy(mem_.virt + ring_bytes_ + CTRL_BYTES, seed, KEYGEN_SEEDBYTES);
+    dev_->sync_to_device(mem_, ring_bytes_ + CTRL_BYTES, KEYGEN_SEEDBYTES);
+    reseed_pending_ = true;
+
+    if (was_running)
+        launch(true);
+}
+
+void KeypairRing::start() {
+    std::lock_guard<std::mutex> lock(m_);
+    if (!started_)
+        launch(reseed_pending_);
+}
+
+void KeypairRing::stop() {
+    std::lock_guard<std::mutex> lock(m_);
+    if (!started_)
+        return;
+    write_word(RING_WORD_STOP, 1);
+    wait_idle();
+    write_word(RING_WORD_STOP, 0);
+}
+
+bool KeypairRing::running() {
+    std::lock_guard<std::mutex> lock(m_);
+    if (started_ && (dev_->read_reg(REG_CTRL) & (CTRL_AP_DONE | CTRL_AP_IDLE)))
+        started_ = false;
+    return started_;
+}
+
+int KeypairRing::available() {
+    std::lock_guard<std::mutex> lock(m_);
+    return (int)(read_word(RING_WORD_HEAD) - tail_);
+}
+
+bool KeypairRing::pop(uint8_t pk[800], uint8_t sk[1632]) {
+    std::lock_guard<std::mutex> lock(m_);
+    if (read_word(RING_WORD_HEAD) == tail_)
+        return false;
+
+    size_t base = (size_t)(tail_ % (uint32_t)slots_) * KEY_BYTES;
+    dev_->sync_from_device(mem_, base, KEY_BYTES);
+    memcpy(pk, mem_.virt + base, KEYGEN_PUBLICKEYBYTES);
+    memcpy(sk, mem_.virt + base + KEYGEN_PUBLICKEYBYTES, KEYGEN_SECRETKEYBYTES);
+    secure_wipe(mem_.virt + base + KEYGEN_PUBLICKEYBYTES, KEYGEN_SECRETKEYBYTES);
+    dev_->sync_to_device(mem_, base + KEYGEN_PUBLICKEYBYTES, KEYGEN_SECRETKEYBYTES);
+
+    // Hand the slot back to the core
+    write_word(RING_WORD_TAIL, ++tail_);
+    popped_++;
+    return true;
+}
+
+bool KeypairRing::reseed_required() {
+    std::lock_guard<std::mutex> lock(m_);
+    return (read_word(RING_WORD_STATUS) & RING_STATUS_RESEED_REQUIRED) != 0;
+}
+
+// Program the ring core for a continuous run and start it
+void KeypairRing::launch(bool reseed) {
+    write_addr(RING_REG_SEED, mem_.phys + ring_bytes_ + CTRL_BYTES);
+    dev_->write_reg(RING_REG_RESEED, reseed ? 1 : 0);
+    write_addr(RING_REG_RING, mem_.phys);
+    write_addr(RING_REG_CTRL, mem_.phys + ring_bytes_);
+    dev_->write_reg(RING_REG_SLOTS, (uint32_t)slots_);
+    dev_->write_reg(RING_REG_NKEYS, 0);
+    dev_->write_reg(REG_CTRL, CTRL_AP_START);
+    started_ = true;
+    reseed_pending_ = false;
+}
+
+void KeypairRing::wait_idle() {
+    while (!(dev_->read_reg(REG_CTRL) & (CTRL_AP_DONE | CTRL_AP_IDLE)))
+        std::this_thread::yield();
+    started_ = false;
+}
@@ -0,0 +1,219 @@
+#ifndef MLKEM_DRIVER_H
+#define MLKEM_DRIVER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// REGISTER MAP OF mlkem512_keygen_top (s_axilite bundle "control")
+// ============================================================================
+
+const uint32_t REG_CTRL = 0x00;     // 0=AP_START 1=AP_DONE 2=AP_IDLE 3=AP_READY
+const uint32_t REG_GIER = 0x04;     // Global interrupt enable
+const uint32_t REG_IP_IER = 0x08;   // 0=ap_done interrupt enable
+const uint32_t REG_IP_ISR = 0x0c;   // 0=ap_done interrupt status (toggle on write)
+const uint32_t REG_D = 0x10;        // 64-bit address of d (lo, hi)
+const uint32_t REG_Z = 0x1c;        // 64-bit address of z
+const uint32_t REG_PK = 0x28;       // 64-bit address of pk
+const uint32_t REG_SK = 0x34;       // 64-bit address of sk
+
+const uint32_t CTRL_AP_START = 1u << 0;
+const uint32_t CTRL_AP_DONE = 1u << 1;
+const uint32_t CTRL_AP_IDLE = 1u << 2;
+const uint32_t CTRL_AP_READY = 1u << 3;
+
+// Sizes of the buffers the core reads and writes
+const size_t KEYGEN_SEEDBYTES = 32;
+const size_t KEYGEN_PUBLICKEYBYTES = 800;
+const size_t KEYGEN_SECRETKEYBYTES = 1632;
+
+// ============================================================================
+// REGISTER MAP OF mlkem512_keygen_ring_top (s_axilite bundle "control")
+// ============================================================================
+// CTRL/GIER/IP_IER/IP_ISR as above. Offsets follow the Vitis HLS layout
+// for these arguments; check against the generated xmlkem512_keygen_ring_top_hw.h.
+
+const uint32_t RING_REG_RETURN = 0x10;  // Keypairs produced by the last run
+const uint32_t RING_REG_SEED = 0x18;    // 64-bit address of the 32-byte seed
+const uint32_t RING_REG_RESEED = 0x24;  // 1: mix seed into the DRBG first
+const uint32_t RING_REG_RING = 0x2c;    // 64-bit address of the keypair ring
+const uint32_t RING_REG_CTRL = 0x38;    // 64-bit address of the ring control block
+const uint32_t RING_REG_SLOTS = 0x44;   // Ring size in keypairs
+const uint32_t RING_REG_NKEYS = 0x4c;   // Keypairs to produce, 0 = until stopped
+
+// Ring control block words (see mlkem512_keygen_ring_top in unified.h)
+const int RING_WORD_HEAD = 0;
+const int RING_WORD_TAIL = 1;
+const int RING_WORD_STOP = 2;
+const int RING_WORD_STATUS = 3;
+const uint32_t RING_STATUS_RESEED_REQUIRED = 1u << 31;
+
+// ============================================================================
+// DEVICE ABSTRACTION
+// ============================================================================
+
+// Physically contiguous buffer shared with the PL
+struct DmaBuffer {
+    uint8_t* virt;
+    uint64_t phys;
+    size_t size;
+};
+
+// One accelerator instance: its register window, a source of contiguous
+// memory and (optionally) its completion interrupt
+class Device {
+public:
+    virtual ~Device() {}
+
+    virtual uint32_t read_reg(uint32_t offset) = 0;
+    virtual void write_reg(uint32_t offset, uint32_t value) = 0;
+
+    // Allocate / release contiguous memory. Drivers allocate once at startup.
+    virtual DmaBuffer alloc(size_t size) = 0;
+    virtual void free(DmaBuffer& buf) = 0;
+
+    // Cache maintenance around device accesses (no-op for coherent/uncached memory)
+    virtual void sync_to_device(const DmaBuffer& buf, size_t offset, size_t len) {}
+    virtual void sync_from_device(const DmaBuffer& buf, size_t offset, size_t len) {}
+
+    // Block until the interrupt line fires or timeout_ms elapses.
+    // Returns false if no interrupt arrived (or interrupts are unsupported).
+    virtual bool wait_irq(int timeout_ms) { return false; }
+};
+
+// ============================================================================
+// KEYGEN DRIVER
+// ============================================================================
+
+// Asynchronous job queue on top of one keygen core. All seed/key buffers
+// live in a single contiguous allocation split into fixed slots, so jobs
+// are handed to the hardware by address with no copies. Callers write d and
+// z straight into a slot, submit it, and read pk/sk from the same slot once
+// it completes. Any number of slots may be queued; a worker thread feeds
+// them to the core back to back.
+class KeygenDriver {
+public:
+    KeygenDriver(Device* dev, int slots, bool use_irq);
+    ~KeygenDriver();
+
+    int slots() const { return (int)state_.size(); }
+
+    // Reserve a free slot, blocking while all slots are in use
+    int acquire();
+    // Non-blocking variant: returns -1 if no slot is free
+    int try_acquire();
+
+    // Zero-copy views of a slot's buffers
+    uint8_t* d(int slot) { return slot_base(slot); }
+    uint8_t* z(int slot) { return slot_base(slot) + KEYGEN_SEEDBYTES; }
+    uint8_t* pk(int slot) { return slot_base(slot) + PK_OFFSET; }
+    uint8_t* sk(int slot) { return slot_base(slot) + SK_OFFSET; }
+
+    // Queue a slot whose d and z have been filled in
+    void submit(int slot);
+    // True once the slot's keypair is available
+    bool poll(int slot);
+    // Block until the slot's keypair is available
+    void wait(int slot);
+    // Same, giving up after timeout_ms: returns false if still in flight
+    bool wait_for(int slot, int timeout_ms);
+    // Wipe the slot (seeds and keypair) and return it to the free pool
+    void release(int slot);
+
+    // Blocking convenience call with copy-in/copy-out
+    void keygen(const uint8_t d[32], const uint8_t z[32], uint8_t pk[800], uint8_t sk[1632]);
+
+    uint64_t completed() const { return completed_; }
+
+private:
+    enum SlotState { SLOT_FREE, SLOT_OWNED, SLOT_QUEUED, SLOT_RUNNING, SLOT_DONE };
+
+    // Slot layout: d | z | pk | sk, every field 8-byte aligned for the 64-bit beats
+    static const size_t PK_OFFSET = 2 * KEYGEN_SEEDBYTES;
+    static const size_t SK_OFFSET = PK_OFFSET + KEYGEN_PUBLICKEYBYTES;
+    static const size_t SLOT_BYTES = (SK_OFFSET + KEYGEN_SECRETKEYBYTES + 63) & ~(size_t)63;
+
+    uint8_t* slot_base(int slot) { return mem_.virt + (size_t)slot * SLOT_BYTES; }
+    uint64_t slot_phys(int slot) const { return mem_.phys + (uint64_t)slot * SLOT_BYTES; }
+
+    void write_addr(uint32_t offset, uint64_t addr);
+    void run_job(int slot);
+    void worker();
+
+    Device* dev_;
+    bool use_irq_;
+    DmaBuffer mem_;
+
+    std::vector<SlotState> state_;
+    std::deque<int> queue_;
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::thread worker_;
+    bool stop_;
+    uint64_t completed_;
+};
+
+// ============================================================================
+// KEYPAIR RING DRIVER
+// ============================================================================
+
+// Host side of mlkem512_keygen_ring_top. The core draws (d, z) from its own
+// DRBG and keeps a DDR ring of ready keypairs full; pop() is then a copy out
+// of the oldest slot instead of a keygen round trip. The ring and its
+// control block are one contiguous allocation: slots of pk || sk, then the
+// head/tail/stop/status words, then the seed.
+class KeypairRing {
+public:
+    KeypairRing(Device* dev, int slots);
+    ~KeypairRing();
+
+    int slots() const { return slots_; }
+
+    // Reseed the on-chip DRBG from 32 bytes of host entropy. Restarts the
+    // core if it is running; required once before the first start().
+    void seed(const uint8_t seed[32]);
+    // Let the core fill the ring continuously until stop()
+    void start();
+    // Ask the core to return after its current keypair and wait for it
+    void stop();
+    bool running();
+
+    // Keypairs ready in the ring
+    int available();
+    // Copy out the oldest keypair and wipe its sk from the ring.
+    // Returns false if the ring is empty.
+    bool pop(uint8_t pk[800], uint8_t sk[1632]);
+    // The DRBG hit its reseed interval: the core has stopped until seed()
+    bool reseed_required();
+
+    uint64_t popped() const { return popped_; }
+
+private:
+    static const size_t KEY_BYTES = KEYGEN_PUBLICKEYBYTES + KEYGEN_SECRETKEYBYTES;
+    static const size_t CTRL_BYTES = 64;
+
+    volatile uint32_t* ctrl() { return (volatile uint32_t*)(mem_.virt + ring_bytes_); }
+    uint32_t read_word(int word);
+    void write_word(int word, uint32_t value);
+    void write_addr(uint32_t offset, uint64_t addr);
+    void launch(bool reseed);
+    void wait_idle();
+
+    Device* dev_;
+    int slots_;
+    size_t ring_bytes_;
+    DmaBuffer mem_;
+    std::mutex m_;
+    uint32_t tail_;
+    bool started_;
+    bool reseed_pending_;
+    uint64_t popped_;
+};
+
+#endif // MLKEM_DRIVER_H
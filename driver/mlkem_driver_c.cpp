@@ -0,0 +1,121 @@
+#include "mlkem_driver_c.h"
+#include "mlkem_driver.h"
+#include "uio_device.h"
+#ifdef MLKEM_MOCK
+#include "mock_device.h"
+#endif
+#include <cstdio>
+#include <exception>
+#include <memory>
+
+struct mlkem_drv {
+    Device* dev;
+    KeygenDriver* drv;
+};
+
+// Takes ownership of dev, also when it fails
+static mlkem_drv* wrap(Device* dev, int slots, int use_irq) {
+    std::unique_ptr<Device> owned(dev);
+    try {
+        std::unique_ptr<mlkem_drv> h(new mlkem_drv);
+        h->dev = dev;
+        h->drv = new KeygenDriver(dev, slots, use_irq != 0);
+        owned.release();
+        return h.release();
+    } catch (const std::exception& e) {
+        fprintf(stderr, "mlkem: %s\n", e.what());
+        return 0;
+    }
+}
+
+mlkem_drv* mlkem_open_uio(const char* uio, const char* udmabuf, int slots, int use_irq) {
+    try {
+        return wrap(new UioDevice(uio, udmabuf), slots, use_irq);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "mlkem: %s\n", e.what());
+        return 0;
+    }
+}
+
+mlkem_drv* mlkem_open_mock(int slots, int use_irq, int latency_us) {
+#ifdef MLKEM_MOCK
+    return wrap(new MockDevice(latency_us), slots, use_irq);
+#else
+    return 0;
+#endif
+}
+
+void mlkem_close(mlkem_drv* h) {
+    if (!h)
+        return;
+    delete h->drv;
+    delete h->dev;
+    delete h;
+}
+
+int mlkem_slots(mlkem_drv* h) {
+    return h->drv->slots();
+}
+
+int mlkem_acquire(mlkem_drv* h) {
+    try {
+        return h->drv->acquire();
+    } catch (const std::exception& e) {
+        fprintf(stderr, "mlkem: %s\n", e.what());
+        return -1;
+    }
+}
+
+int mlkem_try_acquire(mlkem_drv* h) {
+    return h->drv->try_acquire();
+}
+
+uint8_t* mlkem_slot_buffer(mlkem_drv* h, int slot, int which) {
+    if (slot < 0 || slot >= h->drv->slots())
+        return 0;
+    switch (which) {
+    case MLKEM_BUF_D: return h->drv->d(slot);
+    case MLKEM_BUF_Z: return h->drv->z(slot);
+    case MLKEM_BUF_PK: return h->drv->pk(slot);
+    case MLKEM_BUF_SK: return h->drv->sk(slot);
+    default: return 0;
+    }
+}
+
+int mlkem_submit(mlkem_drv* h, int slot) {
+    try {
+        h->drv->submit(slot);
+        return 0;
+    } catch (const std::exception& e) {
+        fprintf(stderr, "mlkem: %s\n", e.what());
+        return -1;
+    }
+}
+
+int mlkem_poll(mlkem_drv* h, int slot) {
+    return h->drv->poll(slot) ? 1 : 0;
+}
+
+int mlkem_wait(mlkem_drv* h, int slot) {
+    try {
+        h->drv->wait(slot);
+        return 0;
+    } catch (const std::exception& e) {
+        fprintf(stderr, "mlkem: %s\n", e.what());
+        return -1;
+    }
+}
+
+int mlkem_release(mlkem_drv* h, int slot) {
+    try {
+        h->drv->release(slot);
+        return 0;
+    } catch (const std::exception& e) {
+        fprintf(stderr, "mlkem: %s\n", e.what());
+        return -1;
+    }
+}
+
+uint64_t mlkem_completed(mlkem_drv* h) {
+    return h->drv->completed();
+}
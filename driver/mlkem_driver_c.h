@@ -0,0 +1,38 @@
+#ifndef MLKEM_DRIVER_C_H
+#define MLKEM_DRIVER_C_H
+
+// Flat C interface to KeygenDriver, used by the Python binding (ctypes).
+// Functions returning int use 0 / a slot index for success and -1 for failure.
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct mlkem_drv mlkem_drv;
+
+// Buffer selectors for mlkem_slot_buffer
+enum { MLKEM_BUF_D = 0, MLKEM_BUF_Z = 1, MLKEM_BUF_PK = 2, MLKEM_BUF_SK = 3 };
+
+// Open the core behind a UIO node with memory from a u-dma-buf node
+mlkem_drv* mlkem_open_uio(const char* uio, const char* udmabuf, int slots, int use_irq);
+// Open a csim-backed mock core (host testing); NULL if built without MOCK=1
+mlkem_drv* mlkem_open_mock(int slots, int use_irq, int latency_us);
+void mlkem_close(mlkem_drv* drv);
+
+int mlkem_slots(mlkem_drv* drv);
+int mlkem_acquire(mlkem_drv* drv);
+int mlkem_try_acquire(mlkem_drv* drv);
+uint8_t* mlkem_slot_buffer(mlkem_drv* drv, int slot, int which);
+int mlkem_submit(mlkem_drv* drv, int slot);
+int mlkem_poll(mlkem_drv* drv, int slot);
+int mlkem_wait(mlkem_drv* drv, int slot);
+int mlkem_release(mlkem_drv* drv, int slot);
+uint64_t mlkem_completed(mlkem_drv* drv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MLKEM_DRIVER_C_H
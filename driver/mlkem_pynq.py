@@ -0,0 +1,155 @@
+"""Python binding for the ML-KEM-512 keygen accelerator driver.
+
+Thin ctypes wrapper over libmlkem_driver.so (see mlkem_driver_c.h). Seed and
+key buffers live in contiguous memory owned by the driver; Job exposes them
+as memoryviews, so seeds are written and keys read in place.
+
+    acc = KeygenAccelerator.open_uio("/dev/uio0", "/dev/udmabuf0")
+    # or, on a host without the board:
+    acc = KeygenAccelerator.open_mock()
+
+    keys, window = [], collections.deque()         # at most acc.slots jobs in flight
+    for d, z in seeds:
+        if len(window) == acc.slots:               # every slot busy: submit() would block
+            keys.append(window.popleft().result()) # waits, copies out, frees slot
+        window.append(acc.submit(d, z))
+    keys += [job.result() for job in window]
+"""
+
+import ctypes
+import os
+
+PUBLICKEYBYTES = 800
+SECRETKEYBYTES = 1632
+SEEDBYTES = 32
+
+_BUF_D, _BUF_Z, _BUF_PK, _BUF_SK = 0, 1, 2, 3
+_BUF_SIZE = {_BUF_D: SEEDBYTES, _BUF_Z: SEEDBYTES, _BUF_PK: PUBLICKEYBYTES, _BUF_SK: SECRETKEYBYTES}
+
+
+def _load(path=None):
+    if path is None:
+        path = os.environ.get("MLKEM_DRIVER_LIB",
+                              os.path.join(os.path.dirname(os.path.abspath(__file__)), "libmlkem_driver.so"))
+    lib = ctypes.CDLL(path)
+    p = ctypes.c_void_p
+    i = ctypes.c_int
+    lib.mlkem_open_uio.argtypes = [ctypes.c_char_p, ctypes.c_char_p, i, i]
+    lib.mlkem_open_uio.restype = p
+    lib.mlkem_open_mock.argtypes = [i, i, i]
+    lib.mlkem_open_mock.restype = p
+    lib.mlkem_close.argtypes = [p]
+    lib.mlkem_close.restype = None
+    for name in ("mlkem_slots", "mlkem_acquire", "mlkem_try_acquire"):
+        getattr(lib, name).argtypes = [p]
+        getattr(lib, name).restype = i
+    lib.mlkem_slot_buffer.argtypes = [p, i, i]
+    lib.mlkem_slot_buffer.restype = ctypes.POINTER(ctypes.c_uint8)
+    for name in ("mlkem_submit", "mlkem_poll", "mlkem_wait", "mlkem_release"):
+        getattr(lib, name).argtypes = [p, i]
+        getattr(lib, name).restype = i
+    lib.mlkem_completed.argtypes = [p]
+    lib.mlkem_completed.restype = ctypes.c_uint64
+    return lib
+
+
+class Job(object):
+    """One keygen request occupying a driver slot until result() or release()."""
+
+    def __init__(self, acc, slot):
+        self._acc = acc
+        self.slot = slot
+
+    def done(self):
+        return self._acc._lib.mlkem_poll(self._acc._h, self.slot) == 1
+
+    def wait(self):
+        if self._acc._lib.mlkem_wait(self._acc._h, self.slot) != 0:
+            raise RuntimeError("mlkem: wait failed")
+
+    @property
+    def pk(self):
+        """Zero-copy view of the public key (valid until release)."""
+        return self._acc._view(self.slot, _BUF_PK)
+
+    @property
+    def sk(self):
+        """Zero-copy view of the secret key (valid until release)."""
+        return self._acc._view(self.slot, _BUF_SK)
+
+    def release(self):
+        if self.slot is not None:
+            self._acc._lib.mlkem_release(self._acc._h, self.slot)
+            self.slot = None
+
+    def result(self):
+        """Wait for completion, copy the keypair out and free the slot."""
+        self.wait()
+        pk, sk = bytes(self.pk), bytes(self.sk)
+        self.release()
+        return pk, sk
+
+
+class KeygenAccelerator(object):
+    def __init__(self, handle, lib):
+        if not handle:
+            raise RuntimeError("mlkem: cannot open device")
+        self._h = handle
+        self._lib = lib
+
+    @classmethod
+    def open_uio(cls, uio="/dev/uio0", udmabuf="/dev/udmabuf0", slots=8, use_irq=True, lib=None):
+        lib = _load(lib)
+        return cls(lib.mlkem_open_uio(uio.encode(), udmabuf.encode(), slots, int(use_irq)), lib)
+
+    @classmethod
+    def open_mock(cls, slots=8, use_irq=False, latency_us=0, lib=None):
+        lib = _load(lib)
+        return cls(lib.mlkem_open_mock(slots, int(use_irq), latency_us), lib)
+
+    def close(self):
+        if self._h:
+            self._lib.mlkem_close(self._h)
+            self._h = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    @property
+    def slots(self):
+        return self._lib.mlkem_slots(self._h)
+
+    @property
+    def completed(self):
+        return self._lib.mlkem_completed(self._h)
+
+    def _view(self, slot, which):
+        ptr = self._lib.mlkem_slot_buffer(self._h, slot, which)
+        arr = (ctypes.c_uint8 * _BUF_SIZE[which]).from_address(ctypes.addressof(ptr.contents))
+        return memoryview(arr).cast("B")
+
+    def submit(self, d, z, block=True):
+        """Queue a keygen for seeds (d, z). Returns a Job, or None if block is
+        False and every slot is busy."""
+        if len(d) != SEEDBYTES or len(z) != SEEDBYTES:
+            raise ValueError("d and z must be 32 bytes")
+        slot = self._lib.mlkem_acquire(self._h) if block else self._lib.mlkem_try_acquire(self._h)
+        if slot < 0:
+            if block:
+                raise RuntimeError("mlkem: acquire failed")
+            return None
+        self._view(slot, _BUF_D)[:] = bytes(d)
+        self._view(slot, _BUF_Z)[:] = bytes(z)
+        if self._lib.mlkem_submit(self._h, slot) != 0:
+            # Never queued: take the seeds back out and free the slot
+            self._view(slot, _BUF_D)[:] = bytes(SEEDBYTES)
+            self._view(slot, _BUF_Z)[:] = bytes(SEEDBYTES)
+            self._lib.mlkem_release(self._h, slot)
+            raise RuntimeError("mlkem: submit failed")
+        return Job(self, slot)
+
+    def keygen(self, d, z):
+        return self.submit(d, z).result()
@@ -0,0 +1,187 @@
+#include "mock_device.h"
+#include "unified.h"
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+MockDevice::MockDevice(int latency_us, MockCore core)
+    : core_type_(core), busy_(false), done_(false), latency_us_(latency_us), jobs_run_(0),
+      next_phys_(0x10000000ULL) {
+    memset(regs_, 0, sizeof(regs_));
+}
+
+MockDevice::~MockDevice() {
+    if (core_.joinable())
+        core_.join();
+    for (size_t i = 0; i < regions_.size(); i++)
+        delete[] regions_[i].virt;
+}
+
+uint32_t MockDevice::read_reg(uint32_t offset) {
+    std::lock_guard<std::mutex> lock(m_);
+    if (offset == REG_CTRL) {
+        uint32_t ctrl = 0;
+        if (busy_)
+            ctrl |= CTRL_AP_START;
+        else
+            ctrl |= CTRL_AP_IDLE | CTRL_AP_READY;
+        if (done_)
+            ctrl |= CTRL_AP_DONE;
+        done_ = false;      // ap_done is clear-on-read
+        return ctrl;
+    }
+    return regs_[offset / 4];
+}
+
+void MockDevice::write_reg(uint32_t offset, uint32_t value) {
+    std::unique_lock<std::mutex> lock(m_);
+    if (offset == REG_CTRL) {
+        if (!(value & CTRL_AP_START) || busy_)
+            return;
+        busy_ = true;
+        done_ = false;
+        lock.unlock();
+        if (core_.joinable())
+            core_.join();
+        core_ = std::thread(core_type_ == MOCK_RING ? &MockDevice::run_ring_core : &MockDevice::run_core, this);
+        return;
+    }
+    if (offset == REG_IP_ISR) {
+        regs_[offset / 4] ^= value;     // toggle on write
+        return;
+    }
+    regs_[offset / 4] = value;
+}
+
+DmaBuffer MockDevice::alloc(size_t size) {
+    std::lock_guard<std::mutex> lock(m_);
+    Region r;
+    r.phys = next_phys_;
+    r.virt = new uint8_t[size]();
+    r.size = size;
+    regions_.push_back(r);
+    next_phys_ += (size + 4095) & ~(uint64_t)4095;
+
+    DmaBuffer buf;
+    buf.virt = r.virt;
+    buf.phys = r.phys;
+    buf.size = size;
+    return buf;
+}
+
+void MockDevice::free(DmaBuffer& buf) {
+    std::lock_guard<std::mutex> lock(m_);
+    for (size_t i = 0; i < regions_.size(); i++) {
+        if (regions_[i].virt == buf.virt) {
+            delete[] regions_[i].virt;
+            regions_.erase(regions_.begin() + i);
+            break;
+        }
+    }
+    buf.virt = 0;
+    buf.size = 0;
+}
+
+bool MockDevice::wait_irq(int timeout_ms) {
+    std::unique_lock<std::mutex> lock(m_);
+    return cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                        [&] { return (regs_[REG_IP_ISR / 4] & 1) != 0; });
+}
+
+void MockDevice::set_latency_us(int latency_us) {
+    std::lock_guard<std::mutex> lock(m_);
+    latency_us_ = latency_us;
+}
+
+uint8_t* MockDevice::translate(uint64_t phys, size_t len) {
+    for (size_t i = 0; i < regions_.size(); i++) {
+        const Region& r = regions_[i];
+        if (phys >= r.phys && phys + len <= r.phys + r.size)
+            return r.virt + (phys - r.phys);
+    }
+    throw std::runtime_error("MockDevice: access outside any allocated buffer");
+}
+
+uint64_t MockDevice::reg64(uint32_t offset) const {
+    return (uint64_t)regs_[offset / 4] | ((uint64_t)regs_[offset / 4 + 1] << 32);
+}
+
+// One invocation of the C-simulated core
+void MockDevice::run_core() {
+    uint8_t *d, *z, *pk, *sk;
+    int latency_us;
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        d = translate(reg64(REG_D), KEYGEN_SEEDBYTES);
+        z = translate(reg64(REG_Z), KEYGEN_SEEDBYTES);
+        pk = translate(reg64(REG_PK), KEYGEN_PUBLICKEYBYTES);
+        sk = translate(reg64(REG_SK), KEYGEN_SECRETKEYBYTES);
+        latency_us = latency_us_;
+    }
+
+    byte_t d_hw[MLKEM_SYMBYTES], z_hw[MLKEM_SYMBYTES];
+    beat_t pk_hw[MLKEM_PUBLICKEYBEATS], sk_hw[MLKEM_SECRETKEYBEATS];
+    for (int i = 0; i < MLKEM_SYMBYTES; i++) {
+        d_hw[i] = d[i];
+        z_hw[i] = z[i];
+    }
+
+    mlkem512_keygen_top(d_hw, z_hw, pk_hw, sk_hw);
+
+    for (int i = 0; i < MLKEM_PUBLICKEYBEATS; i++)
+        for (int j = 0; j < 8; j++)
+            pk[8 * i + j] = (uint8_t)(pk_hw[i] >> (8 * j));
+    for (int i = 0; i < MLKEM_SECRETKEYBEATS; i++)
+        for (int j = 0; j < 8; j++)
+            sk[8 * i + j] = (uint8_t)(sk_hw[i] >> (8 * j));
+
+    if (latency_us > 0)
+        std::this_thread::sleep_for(std::chrono::microseconds(latency_us));
+
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        busy_ = false;
+        done_ = true;
+        jobs_run_++;
+        if ((regs_[REG_GIER / 4] & 1) && (regs_[REG_IP_IER / 4] & 1))
+            regs_[REG_IP_ISR / 4] |= 1;
+    }
+    cv_.notify_all();
+}
+
+// One run of the C-simulated ring core. The ring is handed to the model as
+// beats in place, which relies on ap_uint<64> being a plain 64-bit word.
+void MockDevice::run_ring_core() {
+    static_assert(sizeof(beat_t) == 8, "ring mock needs 8-byte beats");
+    uint8_t* seed;
+    beat_t* ring;
+    volatile uint32_t* ctrl;
+    int reseed, slots, nkeys;
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        slots = (int)regs_[RING_REG_SLOTS / 4];
+        reseed = (int)regs_[RING_REG_RESEED / 4];
+        nkeys = (int)regs_[RING_REG_NKEYS / 4];
+        seed = translate(reg64(RING_REG_SEED), KEYGEN_SEEDBYTES);
+        ring = (beat_t*)translate(reg64(RING_REG_RING), (size_t)slots * KEYGEN_KEY_BEATS * 8);
+        ctrl = (volatile uint32_t*)translate(reg64(RING_REG_CTRL), RING_CTRL_WORDS * 4);
+    }
+
+    beat_t seed_hw[MLKEM_SYMBEATS];
+    for (int i = 0; i < MLKEM_SYMBEATS; i++) {
+        seed_hw[i] = 0;
+        for (int j = 0; j < 8; j++)
+            seed_hw[i] |= (beat_t)seed[8 * i + j] << (8 * j);
+    }
+
+    int produced = mlkem512_keygen_ring_top(seed_hw, reseed, ring, ctrl, slots, nkeys);
+
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        regs_[RING_REG_RETURN / 4] = (uint32_t)produced;
+        busy_ = false;
+        done_ = true;
+        jobs_run_ += produced;
+    }
+    cv_.notify_all();
+}
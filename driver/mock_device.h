@@ -0,0 +1,61 @@
+#ifndef MLKEM_MOCK_DEVICE_H
+#define MLKEM_MOCK_DEVICE_H
+
+#include "mlkem_driver.h"
+
+// Host-side stand-in for one keygen core, for testing the driver on a
+// Linux x86 box. It models the control register file (AP_START/DONE/IDLE,
+// clear-on-read ap_done, GIER/IER/ISR) and runs the C simulation of
+// mlkem512_keygen_top on a background thread when started. "Physical"
+// addresses are handed out from a fake address space and translated back
+// to host memory when the core dereferences d/z/pk/sk. latency_us adds a
+// fixed delay per job to emulate hardware latency.
+//
+// With MOCK_RING the device models mlkem512_keygen_ring_top instead: the
+// C model runs on the background thread for the whole ring run, working
+// on the ring and control block in host memory in place.
+enum MockCore { MOCK_KEYGEN, MOCK_RING };
+
+class MockDevice : public Device {
+public:
+    explicit MockDevice(int latency_us = 0, MockCore core = MOCK_KEYGEN);
+    ~MockDevice();
+
+    uint32_t read_reg(uint32_t offset);
+    void write_reg(uint32_t offset, uint32_t value);
+
+    DmaBuffer alloc(size_t size);
+    void free(DmaBuffer& buf);
+
+    bool wait_irq(int timeout_ms);
+
+    void set_latency_us(int latency_us);
+    uint64_t jobs_run() const { return jobs_run_; }
+
+private:
+    struct Region {
+        uint64_t phys;
+        uint8_t* virt;
+        size_t size;
+    };
+
+    uint8_t* translate(uint64_t phys, size_t len);
+    uint64_t reg64(uint32_t offset) const;
+    void run_core();
+    void run_ring_core();
+
+    std::mutex m_;
+    std::condition_variable cv_;
+    MockCore core_type_;
+    uint32_t regs_[24];
+    bool busy_;
+    bool done_;
+    int latency_us_;
+    uint64_t jobs_run_;
+    std::thread core_;
+
+    std::vector<Region> regions_;
+    uint64_t next_phys_;
+};
+
+#endif // MLKEM_MOCK_DEVICE_H
@@ -0,0 +1,14 @@
+#ifndef MLKEM_SECURE_WIPE_H
+#define MLKEM_SECURE_WIPE_H
+
+#include <stddef.h>
+#include <string.h>
+
+// Zero n bytes of seeds or key material: a memset that the compiler cannot
+// drop as a dead store when the buffer is freed or goes out of scope next
+inline void secure_wipe(void* p, size_t n) {
+    memset(p, 0, n);
+    __asm__ __volatile__("" : : "r"(p) : "memory");
+}
+
+#endif // MLKEM_SECURE_WIPE_H
@@ -0,0 +1,405 @@
+#include "soft_keygen.h"
+#include "secure_wipe.h"
+#include <cstring>
+
+// Same algorithm and parameters as mlkem512_keygen in ../HLS/keygen.cpp,
+// with every array widened by a lane dimension. Loops over l (the lane)
+// are innermost everywhere except in rejection sampling and byte packing,
+// which are inherently per key.
+
+const int L = SOFT_KEYGEN_LANES;
+const int Q = 3329;
+const int N = 256;
+const int K = 2;
+const int ETA1 = 3;
+const int SYMBYTES = 32;
+const int POLYBYTES = 384;
+const int PUBLICKEYBYTES = K * POLYBYTES + SYMBYTES;
+const int SECRETKEYBYTES = K * POLYBYTES + PUBLICKEYBYTES + 2 * SYMBYTES;
+const int SHAKE128_RATE = 168;
+const int SHAKE256_RATE = 136;
+const int SHA3_256_RATE = 136;
+const int SHA3_512_RATE = 72;
+// Three SHAKE128 blocks cover almost every matrix entry; a lane still short
+// after them squeezes further blocks, as poly_uniform in the HLS model does
+const int REJ_BLOCKS = 3;
+const int PRF_BLOCKS = (64 * ETA1 + SHAKE256_RATE - 1) / SHAKE256_RATE;
+
+struct polyx_t {
+    uint16_t c[N][L];
+};
+
+// ============================================================================
+// TABLES
+// ============================================================================
+
+// zeta_k = 17^brv7(k) mod q, and floor(zeta_k * 2^16 / q) for mul_zeta
+struct zeta_tables_t {
+    uint16_t z[128];
+    uint16_t z_shoup[128];
+    uint16_t z_neg[128];
+    uint16_t z_neg_shoup[128];
+
+    zeta_tables_t() {
+        for (int k = 0; k < 128; k++) {
+            int rev = 0;
+            for (int b = 0; b < 7; b++)
+                rev |= ((k >> b) & 1) << (6 - b);
+            uint32_t v = 1;
+            for (int e = 0; e < rev; e++)
+                v = v * 17 % Q;
+            z[k] = (uint16_t)v;
+            z_neg[k] = (uint16_t)((Q - v) % Q);
+            z_shoup[k] = (uint16_t)(((uint32_t)z[k] << 16) / Q);
+            z_neg_shoup[k] = (uint16_t)(((uint32_t)z_neg[k] << 16) / Q);
+        }
+    }
+};
+static const zeta_tables_t zetas;
+
+static const uint64_t KECCAK_RC[24] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
+    0x000000000000808bULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+    0x000000000000008aULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+    0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800aULL, 0x800000008000000aULL,
+    0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL};
+
+// Rho rotations and pi destinations along the lane cycle starting at lane 1
+static constexpr int KECCAK_ROTC[24] = {1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14,
+                                    27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44};
+static constexpr int KECCAK_PILN[24] = {10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4,
+                                    15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1};
+
+// ============================================================================
+// KECCAK, L STATES AT ONCE
+// ============================================================================
+
+static inline uint64_t rol64(uint64_t x, int n) {
+    return (x << n) | (x >> (64 - n));
+}
+
+static inline uint64_t load64(const uint8_t* p) {
+    uint64_t r = 0;
+    for (int i = 0; i < 8; i++)
+        r |= (uint64_t)p[i] << (8 * i);
+    return r;
+}
+
+static inline void store64(uint8_t* p, uint64_t w) {
+    for (int i = 0; i < 8; i++)
+        p[i] = (uint8_t)(w >> (8 * i));
+}
+
+static void keccakx_f1600(uint64_t s[25][L]) {
+    uint64_t c[5][L], t[L];
+
+    for (int round = 0; round < 24; round++) {
+        // Theta
+        for (int x = 0; x < 5; x++) {
+            for (int l = 0; l < L; l++)
+                c[x][l] = s[x][l] ^ s[x + 5][l] ^ s[x + 10][l] ^ s[x + 15][l] ^ s[x + 20][l];
+        }
+        for (int x = 0; x < 5; x++) {
+            for (int l = 0; l < L; l++) {
+                uint64_t d = c[(x + 4) % 5][l] ^ rol64(c[(x + 1) % 5][l], 1);
+                for (int y = 0; y < 25; y += 5)
+                    s[x + y][l] ^= d;
+            }
+        }
+
+        // Rho and pi, along the lane cycle starting at lane 1, unrolled so
+        // every rotation is by a constant
+        for (int l = 0; l < L; l++)
+            t[l] = s[1][l];
+#define KECCAKX_RHO_PI(i) \
+        for (int l = 0; l < L; l++) { \
+            uint64_t next = s[KECCAK_PILN[i]][l]; \
+            s[KECCAK_PILN[i]][l] = rol64(t[l], KECCAK_ROTC[i]); \
+            t[l] = next; \
+        }
+        KECCAKX_RHO_PI(0) KECCAKX_RHO_PI(1) KECCAKX_RHO_PI(2) KECCAKX_RHO_PI(3)
+        KECCAKX_RHO_PI(4) KECCAKX_RHO_PI(5) KECCAKX_RHO_PI(6) KECCAKX_RHO_PI(7)
+        KECCAKX_RHO_PI(8) KECCAKX_RHO_PI(9) KECCAKX_RHO_PI(10) KECCAKX_RHO_PI(11)
+        KECCAKX_RHO_PI(12) KECCAKX_RHO_PI(13) KECCAKX_RHO_PI(14) KECCAKX_RHO_PI(15)
+        KECCAKX_RHO_PI(16) KECCAKX_RHO_PI(17) KECCAKX_RHO_PI(18) KECCAKX_RHO_PI(19)
+        KECCAKX_RHO_PI(20) KECCAKX_RHO_PI(21) KECCAKX_RHO_PI(22) KECCAKX_RHO_PI(23)
+#undef KECCAKX_RHO_PI
+
+        // Chi
+        for (int y = 0; y < 25; y += 5) {
+            for (int x = 0; x < 5; x++) {
+                for (int l = 0; l < L; l++)
+                    c[x][l] = s[y + x][l];
+            }
+            for (int x = 0; x < 5; x++) {
+                for (int l = 0; l < L; l++)
+                    s[y + x][l] = c[x][l] ^ (~c[(x + 1) % 5][l] & c[(x + 2) % 5][l]);
+            }
+        }
+
+        // Iota
+        for (int l = 0; l < L; l++)
+            s[0][l] ^= KECCAK_RC[round];
+    }
+}
+
+// Absorb len bytes per lane (lane l at in + l * stride) and pad with dsep.
+// The last block is left unpermuted: keccakx_squeeze permutes before each
+// block it outputs, so no permutation is spent after the last block used.
+static void keccakx_absorb(uint64_t s[25][L], int rate, const uint8_t* in, size_t stride, int len, uint8_t dsep) {
+    memset(s, 0, sizeof(uint64_t) * 25 * L);
+
+    for (; len >= rate; len -= rate, in += rate) {
+        for (int i = 0; i < rate / 8; i++) {
+            for (int l = 0; l < L; l++)
+                s[i][l] ^= load64(in + l * stride + 8 * i);
+        }
+        keccakx_f1600(s);
+    }
+
+    uint8_t block[200];
+    for (int l = 0; l < L; l++) {
+        memset(block, 0, sizeof(block));
+        memcpy(block, in + l * stride, len);
+        block[len] ^= dsep;
+        block[rate - 1] ^= 0x80;
+        for (int i = 0; i < rate / 8; i++)
+            s[i][l] ^= load64(block + 8 * i);
+    }
+}
+
+// nblocks full output blocks per lane, lane l at out + l * stride
+static void keccakx_squeeze(uint64_t s[25][L], int rate, uint8_t* out, size_t stride, int nblocks) {
+    for (int b = 0; b < nblocks; b++, out += rate) {
+        keccakx_f1600(s);
+        for (int i = 0; i < rate / 8; i++) {
+            for (int l = 0; l < L; l++)
+                store64(out + l * stride + 8 * i, s[i][l]);
+        }
+    }
+}
+
+// ============================================================================
+// ARITHMETIC
+// ============================================================================
+
+static inline uint32_t csubq(uint32_t a) {
+    return a >= (uint32_t)Q ? a - Q : a;
+}
+
+// zeta * b mod q for a table constant zeta (Shoup): with zs = floor(zeta *
+// 2^16 / q) the quotient estimate is low by at most one, so b < 2^16 needs
+// one conditional subtraction and no wide product
+static inline uint32_t mul_zeta(uint32_t b, uint32_t zeta, uint32_t zs) {
+    uint32_t qhat = (b * zs) >> 16;
+    return csubq(b * zeta - qhat * Q);
+}
+
+// Barrett reduction of a sum of products below 2^32 / 32, as barrett_reduce_acc
+static inline uint32_t reduce_acc(uint32_t a) {
+    uint32_t t = (uint32_t)(((uint64_t)a * 1290167) >> 32);
+    return csubq(a - t * Q);
+}
+
+// Forward NTT, coefficients in [0, q) in and out
+static void polyx_ntt(polyx_t* r) {
+    int k = 1;
+    for (int len = 128; len >= 2; len >>= 1) {
+        for (int start = 0; start < N; start += 2 * len, k++) {
+            uint32_t zeta = zetas.z[k], zs = zetas.z_shoup[k];
+            for (int j = start; j < start + len; j++) {
+                for (int l = 0; l < L; l++) {
+                    uint32_t a = r->c[j][l];
+                    uint32_t t = mul_zeta(r->c[j + len][l], zeta, zs);
+                    r->c[j][l] = (uint16_t)csubq(a + t);
+                    r->c[j + len][l] = (uint16_t)csubq(a + Q - t);
+                }
+            }
+        }
+    }
+}
+
+// r = sum_j a[j] * b[j] in the NTT domain: products of every j are summed
+// unreduced and reduced once per coefficient
+static void polyx_basemul_acc(polyx_t* r, const polyx_t a[K], const polyx_t b[K]) {
+    for (int q = 0; q < N / 4; q++) {
+        int c = 4 * q;
+        uint32_t zeta = zetas.z[64 + q], zs = zetas.z_shoup[64 + q];
+        uint32_t zeta_neg = zetas.z_neg[64 + q], zs_neg = zetas.z_neg_shoup[64 + q];
+
+        for (int l = 0; l < L; l++) {
+            uint32_t r0 = 0, r1 = 0, r2 = 0, r3 = 0;
+            for (int j = 0; j < K; j++) {
+                uint32_t a0 = a[j].c[c][l], a1 = a[j].c[c + 1][l];
+                uint32_t a2 = a[j].c[c + 2][l], a3 = a[j].c[c + 3][l];
+                uint32_t b0 = b[j].c[c][l], b1 = b[j].c[c + 1][l];
+                uint32_t b2 = b[j].c[c + 2][l], b3 = b[j].c[c + 3][l];
+                r0 += a0 * b0 + a1 * mul_zeta(b1, zeta, zs);
+                r1 += a0 * b1 + a1 * b0;
+                r2 += a2 * b2 + a3 * mul_zeta(b3, zeta_neg, zs_neg);
+                r3 += a2 * b3 + a3 * b2;
+            }
+            r->c[c][l] = (uint16_t)reduce_acc(r0);
+            r->c[c + 1][l] = (uint16_t)reduce_acc(r1);
+            r->c[c + 2][l] = (uint16_t)reduce_acc(r2);
+            r->c[c + 3][l] = (uint16_t)reduce_acc(r3);
+        }
+    }
+}
+
+// CBD with eta = 3 from 192 bytes per lane (lane l at buf + l * stride)
+static void polyx_cbd_eta1(polyx_t* r, const uint8_t* buf, size_t stride) {
+    for (int i = 0; i < N / 4; i++) {
+        for (int l = 0; l < L; l++) {
+            const uint8_t* p = buf + l * stride + 3 * i;
+            uint32_t t = p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16;
+            // Bit j of each 3-bit group summed in parallel
+            uint32_t d = (t & 0x249249) + ((t >> 1) & 0x249249) + ((t >> 2) & 0x249249);
+            for (int j = 0; j < 4; j++) {
+                uint32_t a = (d >> (6 * j)) & 0x7;
+                uint32_t b = (d >> (6 * j + 3)) & 0x7;
+                r->c[4 * i + j][l] = (uint16_t)csubq(a + Q - b);
+            }
+        }
+    }
+}
+
+// Rejection sampling of one matrix entry per lane from XOF(rho || j || i).
+// Each lane has its own counter; the lanes that are still short after the
+// first REJ_BLOCKS blocks get more, one block at a time.
+static void polyx_uniform(polyx_t* r, const uint8_t rho[L][SYMBYTES], int i, int j) {
+    uint8_t in[L][SYMBYTES + 2];
+    uint8_t buf[L][REJ_BLOCKS * SHAKE128_RATE];
+    uint64_t s[25][L];
+    int ctr[L];
+
+    for (int l = 0; l < L; l++) {
+        memcpy(in[l], rho[l], SYMBYTES);
+        in[l][SYMBYTES] = (uint8_t)j;
+        in[l][SYMBYTES + 1] = (uint8_t)i;
+        ctr[l] = 0;
+    }
+    keccakx_absorb(s, SHAKE128_RATE, in[0], sizeof(in[0]), sizeof(in[0]), 0x1f);
+
+    int len = REJ_BLOCKS * SHAKE128_RATE;
+    keccakx_squeeze(s, SHAKE128_RATE, buf[0], sizeof(buf[0]), REJ_BLOCKS);
+    for (bool short_lane = true; short_lane;) {
+        short_lane = false;
+        for (int l = 0; l < L; l++) {
+            for (int p = 0; p + 3 <= len && ctr[l] < N; p += 3) {
+                uint32_t v1 = (buf[l][p] | (uint32_t)buf[l][p + 1] << 8) & 0xfff;
+                uint32_t v2 = (buf[l][p + 1] >> 4 | (uint32_t)buf[l][p + 2] << 4) & 0xfff;
+                if (v1 < (uint32_t)Q)
+                    r->c[ctr[l]++][l] = (uint16_t)v1;
+                if (v2 < (uint32_t)Q && ctr[l] < N)
+                    r->c[ctr[l]++][l] = (uint16_t)v2;
+            }
+            short_lane |= ctr[l] < N;
+        }
+        if (short_lane) {
+            len = SHAKE128_RATE;
+            keccakx_squeeze(s, SHAKE128_RATE, buf[0], sizeof(buf[0]), 1);
+        }
+    }
+}
+
+// 12-bit little-endian packing (poly_tobytes / poly_tobeats)
+static void polyx_tobytes(uint8_t* r, size_t stride, const polyx_t* a) {
+    for (int l = 0; l < L; l++) {
+        uint8_t* p = r + l * stride;
+        for (int i = 0; i < N; i += 2) {
+            uint32_t t0 = a->c[i][l], t1 = a->c[i + 1][l];
+            p[3 * i / 2] = (uint8_t)t0;
+            p[3 * i / 2 + 1] = (uint8_t)(t0 >> 8 | t1 << 4);
+            p[3 * i / 2 + 2] = (uint8_t)(t1 >> 4);
+        }
+    }
+}
+
+// ============================================================================
+// KEYGEN
+// ============================================================================
+
+// Everything that depends on the seeds, in one place so it can be wiped
+struct soft_keygen_ws_t {
+    uint8_t d[L][SYMBYTES];
+    uint8_t g[L][SHA3_512_RATE];               // rho || sigma || rest of the block
+    uint8_t rho[L][SYMBYTES];
+    uint8_t prf_in[L][SYMBYTES + 1];
+    uint8_t prf[L][PRF_BLOCKS * SHAKE256_RATE];
+    uint8_t keys[L][PUBLICKEYBYTES + SECRETKEYBYTES];
+    uint8_t hash[L][SHA3_256_RATE];
+    uint64_t s[25][L];
+    polyx_t a[K][K];
+    polyx_t s_hat[K];
+    polyx_t e_hat[K];
+    polyx_t t_hat[K];
+};
+
+void soft_keygen_batch(int n, const uint8_t (*d)[32], const uint8_t (*z)[32], uint8_t* out, size_t stride) {
+    soft_keygen_ws_t* w = new soft_keygen_ws_t;
+
+    // Idle lanes run on a zero seed and are dropped at the end
+    memset(w->d, 0, sizeof(w->d));
+    for (int l = 0; l < n && l < L; l++)
+        memcpy(w->d[l], d[l], SYMBYTES);
+
+    // (rho, sigma) := G(d)
+    keccakx_absorb(w->s, SHA3_512_RATE, w->d[0], SYMBYTES, SYMBYTES, 0x06);
+    keccakx_squeeze(w->s, SHA3_512_RATE, w->g[0], SHA3_512_RATE, 1);
+    for (int l = 0; l < L; l++)
+        memcpy(w->rho[l], w->g[l], SYMBYTES);
+
+    for (int i = 0; i < K; i++) {
+        for (int j = 0; j < K; j++)
+            polyx_uniform(&w->a[i][j], w->rho, i, j);
+    }
+
+    // s and e from PRF(sigma, 0 .. 2K - 1)
+    for (int nonce = 0; nonce < 2 * K; nonce++) {
+        for (int l = 0; l < L; l++) {
+            memcpy(w->prf_in[l], w->g[l] + SYMBYTES, SYMBYTES);
+            w->prf_in[l][SYMBYTES] = (uint8_t)nonce;
+        }
+        keccakx_absorb(w->s, SHAKE256_RATE, w->prf_in[0], SYMBYTES + 1, SYMBYTES + 1, 0x1f);
+        keccakx_squeeze(w->s, SHAKE256_RATE, w->prf[0], sizeof(w->prf[0]), PRF_BLOCKS);
+        polyx_t* r = nonce < K ? &w->s_hat[nonce] : &w->e_hat[nonce - K];
+        polyx_cbd_eta1(r, w->prf[0], sizeof(w->prf[0]));
+        polyx_ntt(r);
+    }
+
+    // t = A s + e
+    for (int i = 0; i < K; i++) {
+        polyx_basemul_acc(&w->t_hat[i], w->a[i], w->s_hat);
+        for (int c = 0; c < N; c++) {
+            for (int l = 0; l < L; l++)
+                w->t_hat[i].c[c][l] = (uint16_t)csubq(w->t_hat[i].c[c][l] + w->e_hat[i].c[c][l]);
+        }
+    }
+
+    // pk = t_hat || rho; sk = s_hat || pk || H(pk) || z
+    const size_t ks = sizeof(w->keys[0]);
+    uint8_t* pk = w->keys[0];
+    uint8_t* sk = pk + PUBLICKEYBYTES;
+    for (int i = 0; i < K; i++) {
+        polyx_tobytes(pk + i * POLYBYTES, ks, &w->t_hat[i]);
+        polyx_tobytes(sk + i * POLYBYTES, ks, &w->s_hat[i]);
+    }
+    for (int l = 0; l < L; l++)
+        memcpy(w->keys[l] + K * POLYBYTES, w->rho[l], SYMBYTES);
+
+    keccakx_absorb(w->s, SHA3_256_RATE, pk, ks, PUBLICKEYBYTES, 0x06);
+    keccakx_squeeze(w->s, SHA3_256_RATE, w->hash[0], SHA3_256_RATE, 1);
+
+    for (int l = 0; l < n && l < L; l++) {
+        uint8_t* key = w->keys[l];
+        memcpy(key + PUBLICKEYBYTES + K * POLYBYTES, key, PUBLICKEYBYTES);
+        memcpy(key + PUBLICKEYBYTES + K * POLYBYTES + PUBLICKEYBYTES, w->hash[l], SYMBYTES);
+        memcpy(key + PUBLICKEYBYTES + K * POLYBYTES + PUBLICKEYBYTES + SYMBYTES, z[l], SYMBYTES);
+        memcpy(out + l * stride, key, PUBLICKEYBYTES + SECRETKEYBYTES);
+    }
+
+    secure_wipe(w, sizeof(*w));
+    delete w;
+}
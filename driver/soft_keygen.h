@@ -0,0 +1,27 @@
+#ifndef MLKEM_SOFT_KEYGEN_H
+#define MLKEM_SOFT_KEYGEN_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================================
+// BATCHED SOFTWARE KEYGEN
+// ============================================================================
+// Plain C++ (no Vitis headers), so it is available in board builds too.
+// SOFT_KEYGEN_LANES independent keygens run in lockstep: every buffer is
+// stored structure-of-arrays with the key index innermost (coefficient i of
+// key l at c[i][l], Keccak lane i of key l at s[i][l]), so each step of the
+// algorithm is one loop over the lanes that the compiler turns into SIMD
+// instructions. Rejection sampling keeps one counter per lane. Output is
+// byte for byte that of mlkem512_keygen_top.
+
+#ifndef SOFT_KEYGEN_LANES
+#define SOFT_KEYGEN_LANES 8
+#endif
+static_assert(SOFT_KEYGEN_LANES == 8 || SOFT_KEYGEN_LANES == 16, "SOFT_KEYGEN_LANES must be 8 or 16");
+
+// Up to SOFT_KEYGEN_LANES keypairs at once: keypair i from (d[i], z[i]),
+// pk at out + i * stride and sk 800 bytes after it
+void soft_keygen_batch(int n, const uint8_t (*d)[32], const uint8_t (*z)[32], uint8_t* out, size_t stride);
+
+#endif // MLKEM_SOFT_KEYGEN_H
@@ -0,0 +1,403 @@
+#include <chrono>
+#include <iostream>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include "mlkem_driver.h"
+#include "hybrid_scheduler.h"
+#include "keypair_pool.h"
+#include "mock_device.h"
+#include "soft_keygen.h"
+#include "unified.h"
+
+void print_hex(const byte_t* data, int len, const std::string& label) {
+    std::cout << label << ": ";
+    for (int i = 0; i < len; i++)
+        std::cout << std::hex << (int)data[i];
+    std::cout << std::dec << std::endl;
+}
+
+// Reference keypair straight from the C model of the core
+static void reference_keygen(const uint8_t d[32], const uint8_t z[32], uint8_t pk[800], uint8_t sk[1632]) {
+    byte_t d_hw[32], z_hw[32];
+    beat_t pk_hw[MLKEM_PUBLICKEYBEATS], sk_hw[MLKEM_SECRETKEYBEATS];
+    for (int i = 0; i < 32; i++) {
+        d_hw[i] = d[i];
+        z_hw[i] = z[i];
+    }
+    mlkem512_keygen_top(d_hw, z_hw, pk_hw, sk_hw);
+    for (int i = 0; i < MLKEM_PUBLICKEYBYTES; i++)
+        pk[i] = (uint8_t)(pk_hw[i / 8] >> (8 * (i % 8)));
+    for (int i = 0; i < MLKEM_SECRETKEYBYTES; i++)
+        sk[i] = (uint8_t)(sk_hw[i / 8] >> (8 * (i % 8)));
+}
+
+static void make_seed(int job, uint8_t d[32], uint8_t z[32]) {
+    for (int i = 0; i < 32; i++) {
+        d[i] = (uint8_t)(job * 31 + i * 7 + 1);
+        z[i] = (uint8_t)(job * 17 + i * 3 + 5);
+    }
+}
+
+// Queue more jobs than there are slots and check every keypair
+bool test_async_queue(bool use_irq) {
+    std::cout << "\n=== Testing async job queue (" << (use_irq ? "interrupt" : "polling") << ") ===" << std::endl;
+
+    const int jobs = 12;
+    MockDevice dev(50);
+    KeygenDriver drv(&dev, 4, use_irq);
+    std::vector<int> slot_of(jobs, -1);
+    bool ok = true;
+
+    int next_submit = 0, next_check = 0;
+    while (next_check < jobs) {
+        // Keep as many jobs in flight as there are free slots
+        while (next_submit < jobs) {
+            int slot = drv.try_acquire();
+            if (slot < 0)
+                break;
+            make_seed(next_submit, drv.d(slot), drv.z(slot));
+            drv.submit(slot);
+            slot_of[next_submit++] = slot;
+        }
+
+        int slot = slot_of[next_check];
+        drv.wait(slot);
+
+        uint8_t d[32], z[32], pk[800], sk[1632];
+        make_seed(next_check, d, z);
+        reference_keygen(d, z, pk, sk);
+        if (memcmp(pk, drv.pk(slot), sizeof(pk)) != 0 || memcmp(sk, drv.sk(slot), sizeof(sk)) != 0) {
+            std::cout << "Mismatch on job " << next_check << std::endl;
+            ok = false;
+        }
+        drv.release(slot);
+        next_check++;
+    }
+
+    ok &= drv.completed() == (uint64_t)jobs && dev.jobs_run() == (uint64_t)jobs;
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
+// Blocking copy-in/copy-out call, leaving the slot wiped
+bool test_blocking_keygen() {
+    std::cout << "\n=== Testing blocking keygen ===" << std::endl;
+
+    MockDevice dev;
+    KeygenDriver drv(&dev, 1, false);
+    uint8_t d[32], z[32], pk[800], sk[1632], pk_ref[800], sk_ref[1632];
+    make_seed(99, d, z);
+
+    drv.keygen(d, z, pk, sk);
+    reference_keygen(d, z, pk_ref, sk_ref);
+
+    bool ok = memcmp(pk, pk_ref, sizeof(pk)) == 0 && memcmp(sk, sk_ref, sizeof(sk)) == 0;
+
+    // The released slot keeps neither the seeds nor the keypair
+    int slot = drv.acquire();
+    const uint8_t* bufs[4] = {drv.d(slot), drv.z(slot), drv.pk(slot), drv.sk(slot)};
+    const size_t lens[4] = {32, 32, 800, 1632};
+    for (int b = 0; b < 4; b++) {
+        for (size_t i = 0; i < lens[b]; i++)
+            ok &= bufs[b][i] == 0;
+    }
+    drv.release(slot);
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
+// Ring mode: more keypairs than slots, so the core stalls on a full ring
+// and resumes as keys are popped; every key must come from the DRBG stream
+bool test_keypair_ring() {
+    std::cout << "\n=== Testing keypair ring ===" << std::endl;
+
+    const int keys = 10;
+    MockDevice dev(0, MOCK_RING);
+    KeypairRing ring(&dev, 3);
+    uint8_t seed[32];
+    byte_t key[32], seed_hw[32];
+    bool ok = true;
+
+    for (int i = 0; i < 32; i++) {
+        seed[i] = (uint8_t)(i * 11 + 2);
+        seed_hw[i] = seed[i];
+        key[i] = 0;
+    }
+    drbg_reseed(key, seed_hw);
+
+    ring.seed(seed);
+    ring.start();
+
+    for (int n = 0; n < keys; n++) {
+        uint8_t pk[800], sk[1632], pk_ref[800], sk_ref[1632];
+        while (!ring.pop(pk, sk))
+            std::this_thread::yield();
+
+        byte_t d_hw[32], z_hw[32];
+        uint8_t d[32], z[32];
+        drbg_generate(key, (uint32_t)n, d_hw, z_hw);
+        for (int i = 0; i < 32; i++) {
+            d[i] = d_hw[i];
+            z[i] = z_hw[i];
+        }
+        reference_keygen(d, z, pk_ref, sk_ref);
+        if (memcmp(pk, pk_ref, sizeof(pk)) != 0 || memcmp(sk, sk_ref, sizeof(sk)) != 0) {
+            std::cout << "Mismatch on ring key " << n << std::endl;
+            ok = false;
+        }
+    }
+
+    ring.stop();
+    ok &= !ring.running() && !ring.reseed_required() && ring.popped() == (uint64_t)keys;
+    ok &= ring.available() <= ring.slots();
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
+// Holds refills back until opened, so the test can observe an empty pool,
+// and can fail a number of calls, as a device that goes away would
+class GatedSource : public KeypairSource {
+public:
+    explicit GatedSource(KeypairSource* src) : src_(src), open_(true), failures_(0) {}
+    void generate(int n, uint8_t* dst, size_t stride) {
+        while (!open_)
+            std::this_thread::yield();
+        if (failures_ > 0) {
+            failures_--;
+            throw std::runtime_error("GatedSource: injected failure");
+        }
+        src_->generate(n, dst, stride);
+    }
+    void set_open(bool open) { open_ = open; }
+    void fail_next(int n) { failures_ = n; }
+
+private:
+    KeypairSource* src_;
+    std::atomic<bool> open_;
+    std::atomic<int> failures_;
+};
+
+// Pool over the async driver: fills to capacity, every popped keypair is
+// consistent (sk carries pk and H(pk)), pops below the low-water mark
+// trigger a refill, flush() leaves the pool empty with misses counted, and
+// source failures are counted and retried
+bool test_keypair_pool() {
+    std::cout << "\n=== Testing keypair pool ===" << std::endl;
+
+    MockDevice dev(50);
+    KeygenDriver drv(&dev, 4, false);
+    DriverKeypairSource drv_src(&drv);
+    GatedSource src(&drv_src);
+    src.fail_next(2);
+    KeypairPool pool(&src, 16, 8, 4);
+    bool ok = true;
+
+    while (pool.level() < 16)
+        std::this_thread::yield();
+
+    for (int n = 0; n < 12; n++) {
+        uint8_t pk[800], sk[1632], hash[32];
+        byte_t pk_hw[800], hash_hw[32];
+        if (!pool.pop(pk, sk)) {
+            std::cout << "Pool ran dry on pop " << n << std::endl;
+            ok = false;
+            continue;
+        }
+        for (int i = 0; i < 800; i++)
+            pk_hw[i] = pk[i];
+        sha3_256(pk_hw, 800, hash_hw);
+        for (int i = 0; i < 32; i++)
+            hash[i] = hash_hw[i];
+        if (memcmp(sk + 768, pk, sizeof(pk)) != 0 || memcmp(sk + 1568, hash, sizeof(hash)) != 0) {
+            std::cout << "Inconsistent keypair on pop " << n << std::endl;
+            ok = false;
+        }
+    }
+
+    // Below the low-water mark: the pool must refill itself
+    while (pool.level() < 16)
+        std::this_thread::yield();
+
+    src.set_open(false);
+    pool.flush();
+    uint8_t pk[800], sk[1632];
+    ok &= !pool.pop(pk, sk) && pool.level() == 0;
+
+    PoolMetrics m = pool.metrics();
+    std::cout << "pops " << m.pops << ", misses " << m.misses << ", generated " << m.generated
+              << ", evicted " << m.evicted << ", refill errors " << m.refill_errors
+              << ", pop " << m.pop_ns_avg << " ns avg, "
+              << m.refill_keys_per_s << " keys/s refill" << std::endl;
+    ok &= m.pops == 12 && m.misses == 1 && m.generated == 28 && m.evicted == 16 && m.refill_errors == 2;
+    ok &= m.generated == drv.completed() && m.refill_keys_per_s > 0;
+    src.set_open(true);
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
+// Batched software keygen: byte-identical to the C model of the core over
+// two full batches and a partial one, and faster than one key at a time.
+// Job 6 needs a fourth SHAKE128 block for A[0][1].
+bool test_soft_keygen() {
+    std::cout << "\n=== Testing batched software keygen ===" << std::endl;
+
+    const int keys = 2 * SOFT_KEYGEN_LANES + 3;
+    const size_t stride = KEYGEN_PUBLICKEYBYTES + KEYGEN_SECRETKEYBYTES;
+    std::vector<uint8_t> out(keys * stride);
+    uint8_t d[keys][32], z[keys][32];
+    bool ok = true;
+
+    for (int k = 0; k < keys; k++)
+        make_seed(k, d[k], z[k]);
+    for (int k = 0; k < keys; k += SOFT_KEYGEN_LANES)
+        soft_keygen_batch(std::min(keys - k, SOFT_KEYGEN_LANES), d + k, z + k, &out[k * stride], stride);
+
+    for (int k = 0; k < keys; k++) {
+        uint8_t pk_ref[800], sk_ref[1632];
+        reference_keygen(d[k], z[k], pk_ref, sk_ref);
+        if (memcmp(&out[k * stride], pk_ref, sizeof(pk_ref)) != 0 ||
+            memcmp(&out[k * stride + 800], sk_ref, sizeof(sk_ref)) != 0) {
+            std::cout << "Mismatch on key " << k << std::endl;
+            ok = false;
+        }
+    }
+
+    // Throughput against the one-at-a-time fallback
+    SoftwareKeypairSource single;
+    BatchSoftwareKeypairSource batched;
+    double rate[2];
+    KeypairSource* srcs[2] = {&single, &batched};
+    for (int i = 0; i < 2; i++) {
+        auto t0 = std::chrono::steady_clock::now();
+        srcs[i]->generate(keys, out.data(), stride);
+        std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+        rate[i] = keys / dt.count();
+    }
+    std::cout << "one at a time " << rate[0] << " keys/s, " << SOFT_KEYGEN_LANES << " lanes " << rate[1]
+              << " keys/s (" << rate[1] / rate[0] << "x)" << std::endl;
+    ok &= rate[1] > rate[0];
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
+// Hybrid scheduler over a mock core with 1 ms of latency: a burst from 8
+// threads is split over both backends, a reload (core offline) runs on the
+// CPU only, and a stalled core job is redone on the CPU with the core taken
+// offline until its slot comes back, or until the scheduler is destroyed.
+// Every keypair is checked, and job 6 (four SHAKE128 blocks for A[0][1])
+// must come out the same from both backends.
+bool test_hybrid_scheduler() {
+    std::cout << "\n=== Testing hybrid FPGA/CPU scheduler ===" << std::endl;
+
+    MockDevice dev(1000);
+    KeygenDriver drv(&dev, 4, false);
+    std::atomic<int> bad(0);
+    bool ok = true;
+
+    auto run = [&](HybridScheduler& sched, int job) {
+        uint8_t d[32], z[32], pk[800], sk[1632], pk_ref[800], sk_ref[1632];
+        make_seed(job, d, z);
+        sched.keygen(d, z, pk, sk);
+        reference_keygen(d, z, pk_ref, sk_ref);
+        if (memcmp(pk, pk_ref, sizeof(pk)) != 0 || memcmp(sk, sk_ref, sizeof(sk)) != 0) {
+            std::cout << "Mismatch on job " << job << std::endl;
+            bad++;
+        }
+    };
+
+    {
+        HybridScheduler sched(&drv, 1);
+        uint8_t d[32], z[32], pk[2][800], sk[2][1632];
+        make_seed(6, d, z);
+        // Fresh estimates, so the first job goes to the core
+        sched.keygen(d, z, pk[0], sk[0]);
+        sched.set_fpga_online(false);
+        sched.keygen(d, z, pk[1], sk[1]);
+        HybridStats s = sched.stats();
+        ok &= s.fpga_jobs == 1 && s.cpu_jobs == 1;
+        ok &= memcmp(pk[0], pk[1], sizeof(pk[0])) == 0 && memcmp(sk[0], sk[1], sizeof(sk[0])) == 0;
+    }
+
+    {
+        HybridScheduler sched(&drv, 2);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; t++) {
+            threads.push_back(std::thread([&, t] {
+                for (int j = 0; j < 4; j++)
+                    run(sched, 4 * t + j);
+            }));
+        }
+        for (size_t t = 0; t < threads.size(); t++)
+            threads[t].join();
+
+        HybridStats s = sched.stats();
+        std::cout << "burst: " << s.fpga_jobs << " on the core (" << s.fpga_service_us << " us/job), "
+                  << s.cpu_jobs << " on the CPU (" << s.cpu_batch_us << " us/batch)" << std::endl;
+        ok &= s.fpga_jobs > 0 && s.cpu_jobs > 0 && s.fpga_jobs + s.cpu_jobs == 32 && s.failovers == 0;
+
+        sched.set_fpga_online(false);
+        for (int j = 0; j < 4; j++)
+            run(sched, 40 + j);
+        HybridStats r = sched.stats();
+        ok &= r.fpga_jobs == s.fpga_jobs && r.cpu_jobs == s.cpu_jobs + 4;
+    }
+
+    {
+        // Fresh estimates, so the first job goes to the core, which stalls
+        HybridScheduler sched(&drv, 1, 50);
+        dev.set_latency_us(300000);
+        run(sched, 50);
+        run(sched, 51);
+        HybridStats s = sched.stats();
+        ok &= s.failovers == 1 && !s.fpga_online && s.orphaned == 1 && s.cpu_jobs == 2 && s.fpga_jobs == 0;
+
+        dev.set_latency_us(0);
+        for (int i = 0; i < 100 && sched.stats().orphaned > 0; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            sched.set_fpga_online(true);
+        }
+        s = sched.stats();
+        ok &= s.orphaned == 0 && s.fpga_online;
+    }
+
+    {
+        // Destroyed with a job still stalled on the core: its slot must be
+        // back in the pool once the destructor returns
+        HybridScheduler sched(&drv, 1, 50);
+        dev.set_latency_us(150000);
+        run(sched, 52);
+        ok &= sched.stats().orphaned == 1;
+    }
+    dev.set_latency_us(0);
+    int slots[4];
+    for (int i = 0; i < 4; i++) {
+        slots[i] = drv.try_acquire();
+        ok &= slots[i] >= 0;
+    }
+    for (int i = 0; i < 4; i++) {
+        if (slots[i] >= 0)
+            drv.release(slots[i]);
+    }
+
+    ok &= bad == 0;
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
+int main() {
+    bool all_tests_passed = true;
+
+    all_tests_passed &= test_blocking_keygen();
+    all_tests_passed &= test_async_queue(false);
+    all_tests_passed &= test_async_queue(true);
+    all_tests_passed &= test_keypair_ring();
+    all_tests_passed &= test_keypair_pool();
+    all_tests_passed &= test_soft_keygen();
+    all_tests_passed &= test_hybrid_scheduler();
+
+    return all_tests_passed ? 0 : 1;
+}
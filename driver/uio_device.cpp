@@ -0,0 +1,116 @@
+#include "uio_device.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstdio>
+#include <stdexcept>
+
+// Read a single integer (decimal or 0x-prefixed hex) from a sysfs attribute
+static uint64_t read_sysfs(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "r");
+    if (!f)
+        throw std::runtime_error("UioDevice: cannot open " + path);
+    unsigned long long v = 0;
+    int n = fscanf(f, "%lli", &v);
+    fclose(f);
+    if (n != 1)
+        throw std::runtime_error("UioDevice: cannot parse " + path);
+    return v;
+}
+
+static std::string node_name(const std::string& dev) {
+    size_t p = dev.rfind('/');
+    return p == std::string::npos ? dev : dev.substr(p + 1);
+}
+
+UioDevice::UioDevice(const std::string& uio, const std::string& udmabuf)
+    : uio_fd_(-1), regs_(0), regs_size_(0), dma_fd_(-1), dma_virt_(0), dma_phys_(0), dma_size_(0), dma_used_(0) {
+    // A half-built device releases whatever it already opened or mapped
+    try {
+        // Control registers: UIO map0
+        uio_fd_ = open(uio.c_str(), O_RDWR | O_SYNC);
+        if (uio_fd_ < 0)
+            throw std::runtime_error("UioDevice: cannot open " + uio);
+        regs_size_ = read_sysfs("/sys/class/uio/" + node_name(uio) + "/maps/map0/size");
+        void* r = mmap(0, regs_size_, PROT_READ | PROT_WRITE, MAP_SHARED, uio_fd_, 0);
+        if (r == MAP_FAILED)
+            throw std::runtime_error("UioDevice: cannot map registers of " + uio);
+        regs_ = (volatile uint32_t*)r;
+
+        // Contiguous memory: whole u-dma-buf region, uncached through O_SYNC
+        std::string dma_name = node_name(udmabuf);
+        dma_phys_ = read_sysfs("/sys/class/u-dma-buf/" + dma_name + "/phys_addr");
+        dma_size_ = read_sysfs("/sys/class/u-dma-buf/" + dma_name + "/size");
+        dma_fd_ = open(udmabuf.c_str(), O_RDWR | O_SYNC);
+        if (dma_fd_ < 0)
+            throw std::runtime_error("UioDevice: cannot open " + udmabuf);
+        void* m = mmap(0, dma_size_, PROT_READ | PROT_WRITE, MAP_SHARED, dma_fd_, 0);
+        if (m == MAP_FAILED)
+            throw std::runtime_error("UioDevice: cannot map " + udmabuf);
+        dma_virt_ = (uint8_t*)m;
+    } catch (...) {
+        unmap();
+        throw;
+    }
+}
+
+UioDevice::~UioDevice() {
+    unmap();
+}
+
+void UioDevice::unmap() {
+    if (dma_virt_)
+        munmap(dma_virt_, dma_size_);
+    if (dma_fd_ >= 0)
+        close(dma_fd_);
+    if (regs_)
+        munmap((void*)regs_, regs_size_);
+    if (uio_fd_ >= 0)
+        close(uio_fd_);
+}
+
+uint32_t UioDevice::read_reg(uint32_t offset) {
+    return regs_[offset / 4];
+}
+
+void UioDevice::write_reg(uint32_t offset, uint32_t value) {
+    regs_[offset / 4] = value;
+}
+
+DmaBuffer UioDevice::alloc(size_t size) {
+    size_t start = (dma_used_ + 4095) & ~(size_t)4095;
+    if (start + size > dma_size_)
+        throw std::runtime_error("UioDevice: u-dma-buf region exhausted");
+    dma_used_ = start + size;
+
+    DmaBuffer buf;
+    buf.virt = dma_virt_ + start;
+    buf.phys = dma_phys_ + start;
+    buf.size = size;
+    return buf;
+}
+
+void UioDevice::free(DmaBuffer& buf) {
+    // Bump allocator: space is reclaimed only when the last buffer goes away
+    if (buf.virt + buf.size == dma_virt_ + dma_used_)
+        dma_used_ = buf.virt - dma_virt_;
+    buf.virt = 0;
+    buf.size = 0;
+}
+
+bool UioDevice::wait_irq(int timeout_ms) {
+    // Unmask the interrupt, then wait for the event counter to be readable
+    uint32_t unmask = 1;
+    if (write(uio_fd_, &unmask, sizeof(unmask)) != sizeof(unmask))
+        return false;
+
+    struct pollfd pfd;
+    pfd.fd = uio_fd_;
+    pfd.events = POLLIN;
+    if (poll(&pfd, 1, timeout_ms) <= 0)
+        return false;
+
+    uint32_t count;
+    return read(uio_fd_, &count, sizeof(count)) == sizeof(count);
+}
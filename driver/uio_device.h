@@ -0,0 +1,39 @@
+#ifndef MLKEM_UIO_DEVICE_H
+#define MLKEM_UIO_DEVICE_H
+
+#include "mlkem_driver.h"
+#include <string>
+
+// Linux backend for the board: the core's s_axilite window and interrupt are
+// exposed through a UIO node (/dev/uioN, map0 = control registers), and
+// physically contiguous memory comes from a u-dma-buf node (/dev/udmabufN)
+// opened with O_SYNC, so no cache maintenance is needed. alloc() carves
+// buffers out of the u-dma-buf region with a bump allocator.
+class UioDevice : public Device {
+public:
+    UioDevice(const std::string& uio, const std::string& udmabuf);
+    ~UioDevice();
+
+    uint32_t read_reg(uint32_t offset);
+    void write_reg(uint32_t offset, uint32_t value);
+
+    DmaBuffer alloc(size_t size);
+    void free(DmaBuffer& buf);
+
+    bool wait_irq(int timeout_ms);
+
+private:
+    void unmap();
+
+    int uio_fd_;
+    volatile uint32_t* regs_;
+    size_t regs_size_;
+
+    int dma_fd_;
+    uint8_t* dma_virt_;
+    uint64_t dma_phys_;
+    size_t dma_size_;
+    size_t dma_used_;
+};
+
+#endif // MLKEM_UIO_DEVICE_H